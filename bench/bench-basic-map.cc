@@ -0,0 +1,179 @@
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <casspir.hh>
+#include <BasicMap.hh>
+#include <Solver.hh>
+
+#include "bench.hh"
+
+/**
+ * Describe a standard board for a benchmark's parameters.
+ */
+static std::string board(uint32_t w, uint32_t h, uint64_t num_mines, const char* storage)
+{
+    std::ostringstream parameters;
+    parameters << "w=" << w << " h=" << h << " mines=" << num_mines << " storage=" << storage;
+    return parameters.str();
+}
+
+/**
+ * Measure making a new board and generating it, including the first flip.
+ */
+template <uint32_t W, uint32_t H>
+static void bench_generate(uint64_t num_mines)
+{
+    Casspir::Point click(W/2, H/2);
+    uint64_t seed = 0;
+    uint64_t sum = 0;
+
+    Bench::run("basic_map_generate", board(W, H, num_mines, "fixed"), [&](Bench::Timer&) {
+        for (int i = 0; i < 1000; i++) {
+            Casspir::BasicMap<W, H> map;
+            map.generate_seeded(num_mines, click, ++seed);
+            sum += map.get_num_flipped();
+        }
+        return 1000;
+    });
+
+    Bench::run("basic_map_generate", board(W, H, num_mines, "dynamic"), [&](Bench::Timer&) {
+        for (int i = 0; i < 1000; i++) {
+            Casspir::Map map = casspir_generate_seeded_map(W, H, num_mines, click, ++seed);
+            sum += map.get_num_flipped();
+        }
+        return 1000;
+    });
+
+    //Keep the boards from being optimised away.
+    if (sum == 0) {
+        std::cerr << "nothing flipped" << std::endl;
+    }
+}
+
+/**
+ * Measure the opening flip of a fixed board, the tiles it reveals are the items.
+ */
+template <uint32_t W, uint32_t H>
+static void bench_flip(uint64_t num_mines)
+{
+    Casspir::Point click(W/2, H/2);
+    Casspir::BasicMap<W, H> fixed;
+    fixed.generate_seeded(num_mines, click, 0);
+    Casspir::Map map = casspir_generate_seeded_map(W, H, num_mines, click, 0);
+
+    Bench::run("basic_map_flip", board(W, H, num_mines, "fixed"), [&](Bench::Timer& timer) {
+        timer.pause();
+        fixed.reset();
+        timer.resume();
+        return fixed.flip(click);
+    });
+
+    Bench::run("basic_map_flip", board(W, H, num_mines, "dynamic"), [&](Bench::Timer& timer) {
+        timer.pause();
+        map.reset();
+        timer.resume();
+        return map.flip(click);
+    });
+}
+
+/**
+ * Measure trying a flip on a copy of a board in progress, so the original is left as it was.
+ */
+template <uint32_t W, uint32_t H>
+static void bench_speculative_flip(uint64_t num_mines)
+{
+    Casspir::Point click(W/2, H/2);
+    Casspir::BasicMap<W, H> fixed;
+    fixed.generate_seeded(num_mines, click, 0);
+    Casspir::Map map = casspir_generate_seeded_map(W, H, num_mines, click, 0);
+
+    //Try a flip well away from the opening.
+    Casspir::Point target(0, 0);
+    for (uint64_t i = 0; i < map.get_size(); i++) {
+        if (!map.is_mine(i) && !map.is_flipped(i)) {
+            target = Casspir::Point::from_index(i, W);
+            break;
+        }
+    }
+
+    Bench::run("basic_map_speculative_flip", board(W, H, num_mines, "fixed"), [&](Bench::Timer&) {
+        uint64_t flipped = 0;
+        for (int i = 0; i < 1000; i++) {
+            Casspir::BasicMap<W, H> copy = fixed;
+            flipped += copy.flip(target);
+        }
+        return flipped;
+    });
+
+    Bench::run("basic_map_speculative_flip", board(W, H, num_mines, "dynamic"), [&](Bench::Timer&) {
+        uint64_t flipped = 0;
+        for (int i = 0; i < 1000; i++) {
+            Casspir::Map copy = map;
+            flipped += copy.flip(target);
+        }
+        return flipped;
+    });
+}
+
+/**
+ * Measure solving boards from their opening, the boards solved are the items.
+ * Both storages share a context each, so only the first few solves allocate.
+ */
+template <uint32_t W, uint32_t H>
+static void bench_solve(uint64_t num_mines)
+{
+    Casspir::Point click(W/2, H/2);
+    Casspir::SolverContext fixed_context, context;
+    uint64_t seed = 0;
+    uint64_t guesses = 0;
+
+    Bench::run("basic_map_solve", board(W, H, num_mines, "fixed"), [&](Bench::Timer&) {
+        for (int i = 0; i < 100; i++) {
+            Casspir::BasicMap<W, H> fixed;
+            fixed.generate_seeded(num_mines, click, ++seed);
+            Casspir::BasicSolver< Casspir::BasicMap<W, H> > solver(fixed, fixed_context);
+            solver.solve([](const Casspir::Operation&) {});
+            guesses += solver.get_guesses();
+        }
+        return 100;
+    });
+
+    seed = 0;
+    Bench::run("basic_map_solve", board(W, H, num_mines, "dynamic"), [&](Bench::Timer&) {
+        for (int i = 0; i < 100; i++) {
+            Casspir::Map map = casspir_generate_seeded_map(W, H, num_mines, click, ++seed);
+            Casspir::Solver solver(map, context);
+            solver.solve([](const Casspir::Operation&) {});
+            guesses += solver.get_guesses();
+        }
+        return 100;
+    });
+
+    //Keep the solves from being optimised away.
+    if (guesses == UINT64_MAX) {
+        std::cerr << "guessed everything" << std::endl;
+    }
+}
+
+/**
+ * Compare each standard board on the stack with the same board in a Map.
+ */
+template <uint32_t W, uint32_t H>
+static void bench_standard(uint64_t num_mines)
+{
+    bench_generate<W, H>(num_mines);
+    bench_flip<W, H>(num_mines);
+    bench_speculative_flip<W, H>(num_mines);
+    bench_solve<W, H>(num_mines);
+}
+
+int main (void)
+{
+    bench_standard<9, 9>(10);
+    bench_standard<16, 16>(40);
+    bench_standard<30, 16>(99);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,36 @@
+#include <cstdlib>
+#include <iostream>
+
+#include <casspir.hh>
+
+/**
+ * Measure how fast no-guess boards of the standard sizes can be produced.
+ *
+ * @param name Label for the output.
+ * @param w Width
+ * @param h Height
+ * @param difficulty Difficulty factor 0-255
+ * @param count Number of boards to produce.
+ */
+static void bench_batch_generate(const char* name, uint32_t w, uint32_t h, uint8_t difficulty, uint64_t count)
+{
+    Casspir::BatchResult result = casspir_generate_batch(w, h, difficulty, Casspir::Point(w/2, h/2), count);
+
+    std::cout
+        << "batch_generate"
+        << " board=" << name
+        << " boards=" << result.maps.size()
+        << " attempts=" << result.attempts
+        << " seconds=" << result.seconds
+        << " boards_per_second=" << result.boards_per_second
+        << std::endl;
+}
+
+int main (void)
+{
+    bench_batch_generate("beginner", 9, 9, 43, 10000);
+    bench_batch_generate("intermediate", 16, 16, 60, 2000);
+    bench_batch_generate("expert", 30, 16, 85, 200);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,51 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+
+#include <casspir.hh>
+
+/**
+ * Measure how fast an opening click reveals a large low density board.
+ *
+ * @param edge The board width and height.
+ */
+static void bench_flood_fill(uint32_t edge)
+{
+    //Sparse fixed seed mine field so the opening covers most of the board.
+    std::default_random_engine r_engine(edge);
+    std::uniform_int_distribution<uint32_t> r_distribution(0, edge - 1);
+    std::set<Casspir::Point> mines;
+    uint64_t num_mines = static_cast<uint64_t>(edge) * edge / 1000;
+    while (mines.size() < num_mines) {
+        Casspir::Point position(r_distribution(r_engine), r_distribution(r_engine));
+        if (position.x > 1 || position.y > 1) {
+            mines.insert(position);
+        }
+    }
+
+    Casspir::Map map = casspir_make_map(edge, edge, mines);
+    mines.clear();
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t flipped = map.flip(Casspir::Point(0, 0));
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout
+        << "flood_fill"
+        << " edge=" << edge
+        << " tiles=" << flipped
+        << " seconds=" << elapsed.count()
+        << " tiles_per_second=" << static_cast<uint64_t>(flipped / elapsed.count())
+        << std::endl;
+}
+
+int main (void)
+{
+    bench_flood_fill(1000);
+    bench_flood_fill(4000);
+    bench_flood_fill(16000);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,175 @@
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <casspir.hh>
+#include <TileValues.hh>
+
+#include "bench.hh"
+
+/**
+ * Describe a board for a benchmark's parameters.
+ */
+static std::string board(uint32_t w, uint32_t h, uint8_t difficulty)
+{
+    std::ostringstream parameters;
+    parameters << "w=" << w << " h=" << h << " difficulty=" << static_cast<unsigned>(difficulty);
+    return parameters.str();
+}
+
+/**
+ * Measure generating a board, including the first flip.
+ */
+static void bench_construct(uint32_t w, uint32_t h, uint8_t difficulty)
+{
+    std::default_random_engine r_engine(w * h + difficulty);
+    Bench::run("map_construct", board(w, h, difficulty), [&](Bench::Timer&) {
+        Casspir::Map map(w, h, difficulty, Casspir::Point(w/2, h/2), r_engine);
+        return map.get_size();
+    });
+}
+
+/**
+ * Measure regenerating a board in place with an exact mine count, including the first flip.
+ */
+static void bench_generate_seeded(uint32_t w, uint32_t h, double density)
+{
+    Casspir::Point click(w/2, h/2);
+    uint64_t num_mines = casspir_mines_for_density(w, h, density);
+    Casspir::Map map = casspir_generate_seeded_map(w, h, num_mines, click, 0);
+    uint64_t seed = 0;
+
+    std::ostringstream parameters;
+    parameters << "w=" << w << " h=" << h << " mines=" << num_mines;
+    Bench::run("map_generate_seeded", parameters.str(), [&](Bench::Timer&) {
+        map.generate_seeded(num_mines, click, ++seed);
+        return map.get_size();
+    });
+}
+
+/**
+ * Measure computing every tile's value from the mines with the given kernel.
+ */
+static void bench_tile_values(uint32_t w, uint32_t h, double density, Casspir::TileValues::Kernel kernel, const char* kernel_name)
+{
+    if (!Casspir::TileValues::is_supported(kernel)) {
+        return;
+    }
+
+    Casspir::Map map = casspir_generate_seeded_map(w, h, casspir_mines_for_density(w, h, density), Casspir::Point(w/2, h/2), 0);
+    std::vector<uint8_t> values((map.get_size() + 1) / 2);
+
+    std::ostringstream parameters;
+    parameters << "w=" << w << " h=" << h << " density=" << density << " kernel=" << kernel_name;
+    Bench::run("map_tile_values", parameters.str(), [&](Bench::Timer&) {
+        Casspir::TileValues::compute(map.get_mines(), w, h, values, kernel);
+        return map.get_size();
+    });
+}
+
+/**
+ * Measure the opening flip of a fixed board, the tiles it reveals are the items.
+ */
+static void bench_flip(uint32_t w, uint32_t h, uint8_t difficulty)
+{
+    std::default_random_engine r_engine(w * h + difficulty);
+    Casspir::Point click(w/2, h/2);
+    Casspir::Map map(w, h, difficulty, click, r_engine);
+
+    Bench::run("map_flip", board(w, h, difficulty), [&](Bench::Timer& timer) {
+        timer.pause();
+        map.reset();
+        timer.resume();
+        return map.flip(click);
+    });
+}
+
+/**
+ * Measure trying a flip on a board in progress and undoing it, either by rolling back
+ * to a checkpoint or by flipping a copy of the board.
+ */
+static void bench_speculative_flip(uint32_t w, uint32_t h, bool rollback)
+{
+    Casspir::Point click(w/2, h/2);
+    Casspir::Map map = casspir_generate_seeded_map(w, h, casspir_mines_for_density(w, h, .15), click, 0);
+
+    //Try a flip well away from the opening.
+    Casspir::Point target(0, 0);
+    for (uint64_t i = 0; i < map.get_size(); i++) {
+        if (!map.is_mine(i) && !map.is_flipped(i)) {
+            target = Casspir::Point::from_index(i, w);
+            break;
+        }
+    }
+
+    std::ostringstream parameters;
+    parameters << "w=" << w << " h=" << h << " undo=" << (rollback ? "rollback" : "copy");
+    Bench::run("map_speculative_flip", parameters.str(), [&](Bench::Timer&) {
+        if (rollback) {
+            uint64_t token = map.checkpoint();
+            uint64_t flipped = map.flip(target);
+            map.rollback(token);
+            return flipped;
+        }
+
+        Casspir::Map copy = map;
+        return copy.flip(target);
+    });
+}
+
+/**
+ * Measure visiting the neighbours of every tile.
+ */
+static void bench_neighbours(uint32_t w, uint32_t h)
+{
+    std::default_random_engine r_engine(w * h);
+    Casspir::Map map(w, h, 0, Casspir::Point(0, 0), r_engine);
+    uint64_t sum = 0;
+
+    Bench::run("map_neighbours", board(w, h, 0), [&](Bench::Timer&) {
+        for (uint64_t i = 0; i < map.get_size(); i++) {
+            for (uint64_t neighbour : map.get_neighbours(i)) {
+                sum += neighbour;
+            }
+        }
+        return map.get_size();
+    });
+
+    //Keep the loop from being optimised away.
+    if (sum == 0) {
+        std::cerr << "no neighbours" << std::endl;
+    }
+}
+
+int main (void)
+{
+    bench_construct(9, 9, 43);
+    bench_construct(30, 16, 85);
+    bench_construct(30, 16, 160);
+    bench_construct(100, 100, 85);
+    bench_construct(1000, 1000, 85);
+    bench_construct(1000, 1000, 10);
+
+    bench_generate_seeded(30, 16, .2);
+    bench_generate_seeded(1000, 1000, .2);
+    bench_generate_seeded(1000, 1000, .05);
+
+    bench_tile_values(1000, 1000, .2, Casspir::TileValues::Kernel::SCALAR, "scalar");
+    bench_tile_values(1000, 1000, .2, Casspir::TileValues::Kernel::SSE2, "sse2");
+    bench_tile_values(1000, 1000, .2, Casspir::TileValues::Kernel::AVX2, "avx2");
+
+    bench_flip(30, 16, 43);
+    bench_flip(100, 100, 10);
+    bench_flip(1000, 1000, 0);
+
+    bench_speculative_flip(1000, 1000, false);
+    bench_speculative_flip(1000, 1000, true);
+
+    bench_neighbours(30, 16);
+    bench_neighbours(1000, 1000);
+
+    return EXIT_SUCCESS;
+}
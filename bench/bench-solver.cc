@@ -0,0 +1,166 @@
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <casspir.hh>
+#include <FrontierGroup.hh>
+#include <Solver.hh>
+
+#include "bench.hh"
+
+/**
+ * Exposes the solver's individual phases.
+ */
+class BenchSolver : public Casspir::Solver
+{
+    public:
+        BenchSolver(Casspir::Map& map) : Casspir::Solver(map) {}
+
+        using Casspir::Solver::perform_basic_pass;
+};
+
+/**
+ * Measure the first basic pass over a freshly opened board, the frontier tiles are the items.
+ */
+static void bench_basic_pass(uint32_t w, uint32_t h, uint8_t difficulty)
+{
+    std::default_random_engine r_engine(w * h + difficulty);
+    Casspir::Point click(w/2, h/2);
+    Casspir::Map map(w, h, difficulty, click, r_engine);
+
+    std::ostringstream parameters;
+    parameters << "w=" << w << " h=" << h << " difficulty=" << static_cast<unsigned>(difficulty);
+    Bench::run("solver_basic_pass", parameters.str(), [&](Bench::Timer& timer) {
+        timer.pause();
+        map.reset();
+        map.flip(click);
+        uint64_t frontier = map.get_frontier_size();
+        BenchSolver solver(map);
+        timer.resume();
+
+        solver.perform_basic_pass();
+        return frontier;
+    });
+}
+
+/**
+ * Measure enumerating a row of unflipped tiles under a row of numbers,
+ * with a mine in every third tile and the last so no number is a zero.
+ *
+ * @param size The number of tiles in the group.
+ */
+static void bench_evaluate_group(uint32_t size)
+{
+    std::set<Casspir::Point> mines;
+    for (uint32_t x = 1; x < size; x += 3) {
+        mines.insert(Casspir::Point(x, 0));
+    }
+    mines.insert(Casspir::Point(size - 1, 0));
+    Casspir::Map map = casspir_make_map(size, 2, mines);
+
+    std::vector<uint64_t> cells, numbers;
+    for (uint32_t x = 0; x < size; x++) {
+        map.flip(Casspir::Point(x, 1));
+        cells.push_back(x);
+        numbers.push_back(size + x);
+    }
+
+    Casspir::FrontierGroup group(map, cells, numbers);
+
+    std::ostringstream parameters;
+    parameters << "size=" << size;
+    Bench::run("solver_evaluate_group", parameters.str(), [&](Bench::Timer&) {
+        group.enumerate(size);
+        return group.get_solutions();
+    });
+}
+
+/**
+ * Measure solving a fixed corpus of boards, the boards are the items.
+ */
+static void bench_solve(const char* name, uint32_t w, uint32_t h, uint8_t difficulty, uint64_t count)
+{
+    std::default_random_engine r_engine(w * h + difficulty);
+    Casspir::Point click(w/2, h/2);
+    std::vector<Casspir::Map> corpus;
+    for (uint64_t i = 0; i < count; i++) {
+        corpus.emplace_back(w, h, difficulty, click, r_engine);
+    }
+
+    uint64_t completed;
+    std::ostringstream parameters;
+    parameters << "board=" << name << " boards=" << count;
+    Bench::run("solve", parameters.str(), [&](Bench::Timer& timer) {
+        completed = 0;
+        for (Casspir::Map& map : corpus) {
+            timer.pause();
+            Casspir::Map copy = map;
+            timer.resume();
+
+            casspir_solve(copy);
+            completed += copy.get_status() == Casspir::MapStatus::COMPLETE;
+        }
+        return corpus.size();
+    });
+
+    std::cout << "solve_completed " << parameters.str() << " completed=" << completed << std::endl;
+}
+
+/**
+ * Measure streaming solves of a fixed corpus of boards, with a fresh solver context for each board
+ * or one context shared by them all.
+ */
+static void bench_solve_context(const char* name, uint32_t w, uint32_t h, uint8_t difficulty, uint64_t count, bool shared)
+{
+    std::default_random_engine r_engine(w * h + difficulty);
+    Casspir::Point click(w/2, h/2);
+    std::vector<Casspir::Map> corpus;
+    for (uint64_t i = 0; i < count; i++) {
+        corpus.emplace_back(w, h, difficulty, click, r_engine);
+    }
+
+    Casspir::SolverContext context;
+    Casspir::OperationSink ignore_operations = [](const Casspir::Operation&) {};
+
+    std::ostringstream parameters;
+    parameters << "board=" << name << " boards=" << count << " context=" << (shared ? "shared" : "own");
+    Bench::run("solve_streamed", parameters.str(), [&](Bench::Timer& timer) {
+        for (Casspir::Map& map : corpus) {
+            timer.pause();
+            Casspir::Map copy = map;
+            timer.resume();
+
+            if (shared) {
+                casspir_solve(copy, context, ignore_operations);
+            } else {
+                casspir_solve(copy, ignore_operations);
+            }
+        }
+        return corpus.size();
+    });
+}
+
+int main (void)
+{
+    bench_basic_pass(30, 16, 85);
+    bench_basic_pass(1000, 1000, 85);
+
+    for (uint32_t size = 8; size <= 24; size += 4) {
+        bench_evaluate_group(size);
+    }
+
+    bench_solve("beginner", 9, 9, 43, 200);
+    bench_solve("intermediate", 16, 16, 60, 100);
+    bench_solve("expert", 30, 16, 85, 50);
+
+    bench_solve_context("beginner", 9, 9, 43, 200, false);
+    bench_solve_context("beginner", 9, 9, 43, 200, true);
+    bench_solve_context("expert", 30, 16, 85, 50, false);
+    bench_solve_context("expert", 30, 16, 85, 50, true);
+
+    return EXIT_SUCCESS;
+}
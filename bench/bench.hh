@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace Bench
+{
+    //Each benchmark repeats until it has run for at least this long, and at least this many times.
+    const double MIN_SECONDS = 0.5;
+    const uint64_t MIN_ITERATIONS = 3;
+
+    /**
+     * Accumulates the time spent in the measured part of each iteration.
+     * Setup done between pause and resume isn't counted.
+     */
+    class Timer
+    {
+        public:
+            Timer() : seconds(0), running(false) {}
+
+            void resume()
+            {
+                if (!this->running) {
+                    this->start = std::chrono::steady_clock::now();
+                    this->running = true;
+                }
+            }
+
+            void pause()
+            {
+                if (this->running) {
+                    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - this->start;
+                    this->seconds += elapsed.count();
+                    this->running = false;
+                }
+            }
+
+            double get_seconds()
+            {
+                return this->seconds;
+            }
+
+        private:
+            std::chrono::steady_clock::time_point start;
+            double seconds;
+            bool running;
+    };
+
+    /**
+     * Run a benchmark and print one line of space separated key=value pairs,
+     * starting with the benchmark name and the given parameters.
+     *
+     * @param name Benchmark name.
+     * @param parameters What's being measured, as key=value pairs.
+     * @param iteration Called with the timer running, returns the number of items it processed.
+     */
+    template<typename F>
+    void run(const std::string& name, const std::string& parameters, F iteration)
+    {
+        Timer timer;
+        uint64_t iterations = 0;
+        uint64_t items = 0;
+        while (timer.get_seconds() < MIN_SECONDS || iterations < MIN_ITERATIONS) {
+            timer.resume();
+            items += iteration(timer);
+            timer.pause();
+            iterations++;
+        }
+
+        double seconds = timer.get_seconds();
+        std::cout
+            << name
+            << " " << parameters
+            << " iterations=" << iterations
+            << " seconds=" << seconds
+            << " ns_per_iteration=" << static_cast<uint64_t>(seconds * 1e9 / iterations)
+            << " items_per_second=" << static_cast<uint64_t>(items / seconds)
+            << std::endl;
+    }
+}
@@ -0,0 +1,258 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <casspir.hh>
+#include <Service.hh>
+
+#include "socket.hh"
+
+using namespace Casspir::ServiceFormat;
+
+struct Options {
+    Socket::Address address;
+    RequestType type;
+    uint32_t width, height;
+    uint64_t num_mines;
+    unsigned connections;
+    uint64_t requests;
+    uint64_t depth;
+
+    Options() : type(SOLVE), width(30), height(16), num_mines(99), connections(1), requests(10000), depth(32) {}
+};
+
+/**
+ * Boards to solve or hint on, generated up front so the client's own work stays out of the way.
+ */
+struct Boards {
+    static const uint64_t COUNT = 256;
+
+    BoardRequest board;
+    std::vector<uint64_t> mines;
+    uint64_t num_words;
+
+    Boards(const Options& options)
+    {
+        Casspir::Point click(options.width / 2, options.height / 2);
+        this->board = {options.width, options.height, click.x, click.y, 0};
+        this->num_words = (static_cast<uint64_t>(options.width) * options.height + 63) / 64;
+
+        for (uint64_t seed = 0; seed < COUNT; seed++) {
+            Casspir::Map map = casspir_generate_seeded_map(options.width, options.height, options.num_mines, click, seed);
+            const Casspir::Bitplane& board_mines = map.get_mines();
+            for (uint64_t w = 0; w < this->num_words; w++) {
+                this->mines.push_back(board_mines.word(w));
+            }
+        }
+    }
+
+    const uint64_t* get_mines(uint64_t id) const
+    {
+        return this->mines.data() + (id % COUNT) * this->num_words;
+    }
+};
+
+/**
+ * What one connection saw.
+ */
+struct Results {
+    Casspir::Latencies round_trip, service;
+    uint64_t errors;
+
+    Results() : errors(0) {}
+};
+
+/**
+ * Append the request with the given id.
+ */
+static void append_request(std::vector<uint8_t>& message, const Options& options, const Boards& boards, uint64_t id)
+{
+    if (options.type == GENERATE) {
+        GenerateRequest request = {
+            options.width,
+            options.height,
+            options.width / 2,
+            options.height / 2,
+            options.num_mines,
+            id
+        };
+        append_generate(message, id, request);
+    } else {
+        append_board(message, options.type, id, boards.board, boards.get_mines(id), nullptr);
+    }
+}
+
+/**
+ * Keep up to depth requests in flight on one connection until they've all been answered.
+ * Requests are written in batches, as many as fit under the depth each time.
+ */
+static bool run_connection(const Options& options, const Boards& boards, Results& results)
+{
+    int fd = Socket::connect(options.address);
+    if (fd < 0) {
+        return false;
+    }
+    Socket::set_no_delay(fd);
+
+    std::vector<std::chrono::steady_clock::time_point> sent_at(options.requests);
+    std::vector<uint8_t> message, body;
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    bool ok = true;
+
+    while (ok && received < options.requests) {
+        message.clear();
+        auto now = std::chrono::steady_clock::now();
+        for (; sent < options.requests && sent - received < options.depth; sent++) {
+            append_request(message, options, boards, sent);
+            sent_at[sent] = now;
+        }
+        if (!message.empty() && !Socket::write_fully(fd, message.data(), message.size())) {
+            ok = false;
+            break;
+        }
+
+        ResponseHeader header;
+        if (!Socket::read_fully(fd, &header, sizeof(header)) || header.length > MAX_LENGTH || header.id >= sent) {
+            ok = false;
+            break;
+        }
+        body.resize(header.length);
+        if (!Socket::read_fully(fd, body.data(), header.length)) {
+            ok = false;
+            break;
+        }
+
+        std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - sent_at[header.id];
+        results.round_trip.add(elapsed.count());
+        results.service.add(header.service_ns);
+        results.errors += header.status != OK;
+        received++;
+    }
+
+    close(fd);
+    return ok;
+}
+
+static void report(const char* kind, Casspir::Latencies& latencies)
+{
+    std::cout
+        << "load_latency kind=" << kind
+        << " p50_us=" << latencies.percentile(.5) / 1000.
+        << " p90_us=" << latencies.percentile(.9) / 1000.
+        << " p99_us=" << latencies.percentile(.99) / 1000.
+        << " max_us=" << latencies.percentile(1) / 1000.
+        << std::endl;
+}
+
+static int usage()
+{
+    std::cerr
+        << "usage: casspir-load (--unix PATH | --port PORT) [--type generate|solve|hint]" << std::endl
+        << "                    [--connections N] [--requests N] [--depth N]" << std::endl
+        << "                    [--width W] [--height H] [--mines N]" << std::endl
+        << "Sends pipelined requests to casspir-server, up to depth in flight on each connection," << std::endl
+        << "and prints the throughput and latency percentiles." << std::endl;
+    return EXIT_FAILURE;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (i + 1 >= argc) {
+            return usage();
+        }
+        std::string value = argv[++i];
+
+        if (argument == "--type") {
+            if (value == "generate") {
+                options.type = GENERATE;
+            } else if (value == "solve") {
+                options.type = SOLVE;
+            } else if (value == "hint") {
+                options.type = HINT;
+            } else {
+                return usage();
+            }
+        } else if (argument == "--connections") {
+            options.connections = std::atoi(value.c_str());
+        } else if (argument == "--requests") {
+            options.requests = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (argument == "--depth") {
+            options.depth = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (argument == "--width") {
+            options.width = std::atoi(value.c_str());
+        } else if (argument == "--height") {
+            options.height = std::atoi(value.c_str());
+        } else if (argument == "--mines") {
+            options.num_mines = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (!options.address.parse(argument, value)) {
+            return usage();
+        }
+    }
+
+    if (!options.address.is_set() || options.connections == 0 || options.depth == 0
+    || options.width == 0 || options.height == 0
+    ) {
+        return usage();
+    }
+
+    Boards boards(options);
+    std::vector<Results> results(options.connections);
+    std::vector<std::thread> threads;
+    std::mutex failed_mutex;
+    bool failed = false;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned c = 0; c < options.connections; c++) {
+        threads.emplace_back([&, c]() {
+            if (!run_connection(options, boards, results[c])) {
+                std::lock_guard<std::mutex> lock(failed_mutex);
+                failed = true;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (failed) {
+        std::cerr << "casspir-load: a connection to " << options.address.describe() << " failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Results total;
+    for (Results& result : results) {
+        total.round_trip.merge(result.round_trip);
+        total.service.merge(result.service);
+        total.errors += result.errors;
+    }
+
+    const char* type_names[] = {"", "generate", "solve", "hint"};
+    std::cout
+        << "load type=" << type_names[options.type]
+        << " w=" << options.width
+        << " h=" << options.height
+        << " mines=" << options.num_mines
+        << " connections=" << options.connections
+        << " depth=" << options.depth
+        << " requests=" << total.round_trip.size()
+        << " errors=" << total.errors
+        << " seconds=" << elapsed.count()
+        << " requests_per_second=" << static_cast<uint64_t>(total.round_trip.size() / elapsed.count())
+        << std::endl;
+    report("round_trip", total.round_trip);
+    report("service", total.service);
+
+    return total.errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
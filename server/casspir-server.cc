@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <Service.hh>
+#include <ThreadPool.hh>
+
+#include "socket.hh"
+
+using namespace Casspir::ServiceFormat;
+
+static volatile std::sig_atomic_t stopping = 0;
+
+static void stop(int)
+{
+    stopping = 1;
+}
+
+//A response that can't be written for this long drops it's connection, so a client that stops reading can't hold a worker.
+static const unsigned WRITE_TIMEOUT_SECONDS = 2;
+
+/**
+ * A client connection, closed once it's reader and every response to it are done with it.
+ * Responses are written whole, one at a time, as workers finish them.
+ * Once a write fails the connection is shut down, and it's remaining requests are dropped unanswered.
+ */
+struct Connection {
+    int fd;
+    std::mutex write_mutex;
+    std::atomic<bool> dropped;
+
+    Connection(int fd) : fd(fd), dropped(false) {}
+
+    /**
+     * Write a response, dropping the connection if it can't be written.
+     */
+    void respond(const std::vector<uint8_t>& response)
+    {
+        std::lock_guard<std::mutex> lock(this->write_mutex);
+        if (!this->dropped && !Socket::write_fully(this->fd, response.data(), response.size())) {
+            this->dropped = true;
+            shutdown(this->fd, SHUT_RDWR);
+        }
+    }
+
+    ~Connection()
+    {
+        close(this->fd);
+    }
+};
+
+struct Job {
+    std::shared_ptr<Connection> connection;
+    std::vector<uint8_t> request;
+    std::chrono::steady_clock::time_point received;
+};
+
+/**
+ * Requests waiting for a worker, from every connection.
+ */
+class JobQueue
+{
+    public:
+        JobQueue() : closed(false) {}
+
+        void push(Job job)
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->jobs.push_back(std::move(job));
+            }
+            this->ready.notify_one();
+        }
+
+        /**
+         * Wait for a job.
+         *
+         * @return false once the queue is closed and empty.
+         */
+        bool pop(Job& job)
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->ready.wait(lock, [this] { return this->closed || !this->jobs.empty(); });
+            if (this->jobs.empty()) {
+                return false;
+            }
+
+            job = std::move(this->jobs.front());
+            this->jobs.pop_front();
+            return true;
+        }
+
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->closed = true;
+            }
+            this->ready.notify_all();
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<Job> jobs;
+        bool closed;
+};
+
+/**
+ * A thread reading one connection's requests, joined once it's finished.
+ */
+struct Reader {
+    std::weak_ptr<Connection> connection;
+    std::shared_ptr< std::atomic<bool> > finished;
+    std::thread thread;
+};
+
+//Bodies are read this much at a time, so a header claiming a huge length costs nothing until the bytes arrive.
+static const size_t READ_CHUNK = 64 * 1024;
+
+/**
+ * Read requests off a connection until it's closed, queueing each one whole.
+ */
+static void read_requests(std::shared_ptr<Connection> connection, JobQueue& queue)
+{
+    while (true) {
+        RequestHeader header;
+        if (!Socket::read_fully(connection->fd, &header, sizeof(header)) || header.length > MAX_LENGTH) {
+            return;
+        }
+
+        Job job;
+        size_t total = sizeof(header) + header.length;
+        job.request.resize(sizeof(header));
+        std::memcpy(job.request.data(), &header, sizeof(header));
+        while (job.request.size() < total) {
+            size_t offset = job.request.size();
+            size_t chunk = std::min(total - offset, READ_CHUNK);
+            job.request.resize(offset + chunk);
+            if (!Socket::read_fully(connection->fd, job.request.data() + offset, chunk)) {
+                return;
+            }
+        }
+
+        job.connection = connection;
+        job.received = std::chrono::steady_clock::now();
+        queue.push(std::move(job));
+    }
+}
+
+/**
+ * Join the readers whose connections have closed, so a long running server only keeps the live ones.
+ */
+static void join_finished(std::vector<Reader>& readers)
+{
+    for (size_t i = 0; i < readers.size();) {
+        if (readers[i].finished->load()) {
+            readers[i].thread.join();
+            std::swap(readers[i], readers.back());
+            readers.pop_back();
+        } else {
+            i++;
+        }
+    }
+}
+
+/**
+ * Print the latency percentiles of a request type, from being read to the response being written.
+ */
+static void report(const char* type, Casspir::Latencies& latencies)
+{
+    if (latencies.size() == 0) {
+        return;
+    }
+
+    std::cout
+        << "server_latency type=" << type
+        << " requests=" << latencies.size()
+        << " p50_us=" << latencies.percentile(.5) / 1000.
+        << " p90_us=" << latencies.percentile(.9) / 1000.
+        << " p99_us=" << latencies.percentile(.99) / 1000.
+        << " max_us=" << latencies.percentile(1) / 1000.
+        << std::endl;
+}
+
+static int usage()
+{
+    std::cerr
+        << "usage: casspir-server (--unix PATH | --port PORT) [--threads N]" << std::endl
+        << "Serves generate, solve and hint requests on a unix socket or localhost TCP port" << std::endl
+        << "until interrupted, then prints request latency percentiles." << std::endl;
+    return EXIT_FAILURE;
+}
+
+int main(int argc, char** argv)
+{
+    Socket::Address address;
+    unsigned threads = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (i + 1 >= argc) {
+            return usage();
+        }
+        if (argument == "--threads") {
+            threads = std::atoi(argv[++i]);
+        } else if (!address.parse(argument, argv[++i])) {
+            return usage();
+        }
+    }
+
+    if (!address.is_set()) {
+        return usage();
+    }
+
+    int listener = Socket::listen(address);
+    if (listener < 0) {
+        std::cerr << "casspir-server: couldn't listen on " << address.describe() << ": " << std::strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+
+    Casspir::ThreadPool thread_pool(threads);
+    JobQueue queue;
+
+    //Accept connections until stopped, then close them so their readers finish and the queue drains.
+    std::thread acceptor([&]() {
+        std::vector<Reader> readers;
+
+        while (!stopping) {
+            join_finished(readers);
+
+            pollfd waiting = {listener, POLLIN, 0};
+            if (poll(&waiting, 1, 100) <= 0) {
+                continue;
+            }
+
+            int fd = accept(listener, nullptr, nullptr);
+            if (fd < 0) {
+                continue;
+            }
+            Socket::set_no_delay(fd);
+            Socket::set_send_timeout(fd, WRITE_TIMEOUT_SECONDS);
+
+            std::shared_ptr<Connection> connection = std::make_shared<Connection>(fd);
+            std::shared_ptr< std::atomic<bool> > finished = std::make_shared< std::atomic<bool> >(false);
+            Reader reader;
+            reader.connection = connection;
+            reader.finished = finished;
+            reader.thread = std::thread([connection, finished, &queue]() {
+                read_requests(connection, queue);
+                finished->store(true);
+            });
+            readers.push_back(std::move(reader));
+        }
+
+        close(listener);
+        for (auto& reader : readers) {
+            if (std::shared_ptr<Connection> open = reader.connection.lock()) {
+                shutdown(open->fd, SHUT_RD);
+            }
+        }
+        for (auto& reader : readers) {
+            reader.thread.join();
+        }
+        queue.close();
+    });
+
+    //One long running worker per thread, each with it's own service and so it's own solver storage.
+    std::vector< std::vector<Casspir::Latencies> > latencies(thread_pool.size(), std::vector<Casspir::Latencies>(HINT + 1));
+    thread_pool.parallel_for(thread_pool.size(), [&](size_t thread) {
+        Casspir::Service service;
+        std::vector<uint8_t> response;
+        Job job;
+
+        while (queue.pop(job)) {
+            if (job.connection->dropped) {
+                job.connection.reset();
+                continue;
+            }
+
+            bool handled = service.handle(job.request.data(), job.request.size(), response);
+            job.connection->respond(response);
+
+            std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - job.received;
+            uint32_t type = handled ? read<RequestHeader>(job.request.data()).type : 0;
+            latencies[thread][type].add(elapsed.count());
+            job.connection.reset();
+        }
+    });
+    acceptor.join();
+    address.remove();
+
+    std::vector<Casspir::Latencies> totals(HINT + 1);
+    for (auto& thread : latencies) {
+        for (size_t type = 0; type < totals.size(); type++) {
+            totals[type].merge(thread[type]);
+        }
+    }
+    report("generate", totals[GENERATE]);
+    report("solve", totals[SOLVE]);
+    report("hint", totals[HINT]);
+    report("bad_request", totals[0]);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Socket
+{
+    /**
+     * Where the server listens, a unix socket path or a TCP port on localhost.
+     */
+    struct Address {
+        std::string path;
+        uint16_t port;
+
+        Address() : port(0) {}
+
+        /**
+         * Take the address from a --unix or --port option.
+         *
+         * @return false if the option isn't one of them.
+         */
+        bool parse(const std::string& option, const std::string& value)
+        {
+            if (option == "--unix") {
+                this->path = value;
+                return !value.empty();
+            } else if (option == "--port") {
+                this->port = std::atoi(value.c_str());
+                return this->port != 0;
+            }
+            return false;
+        }
+
+        bool is_set() const
+        {
+            return !this->path.empty() || this->port != 0;
+        }
+
+        std::string describe() const
+        {
+            return this->path.empty() ? "127.0.0.1:" + std::to_string(this->port) : this->path;
+        }
+
+        /**
+         * Remove a unix socket's file, whether stale or no longer listened on.
+         * Anything at the path that isn't a socket is left alone.
+         */
+        void remove() const
+        {
+            struct stat status;
+            if (!this->path.empty() && lstat(this->path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+                unlink(this->path.c_str());
+            }
+        }
+    };
+
+    /**
+     * Make a socket of the address's family and fill in it's socket address.
+     *
+     * @return The socket, or -1 on failure.
+     */
+    inline int open(const Address& address, sockaddr_storage& storage, socklen_t& length)
+    {
+        std::memset(&storage, 0, sizeof(storage));
+
+        if (!address.path.empty()) {
+            sockaddr_un* local = reinterpret_cast<sockaddr_un*>(&storage);
+            if (address.path.size() >= sizeof(local->sun_path)) {
+                errno = ENAMETOOLONG;
+                return -1;
+            }
+            local->sun_family = AF_UNIX;
+            std::strcpy(local->sun_path, address.path.c_str());
+            length = sizeof(sockaddr_un);
+            return socket(AF_UNIX, SOCK_STREAM, 0);
+        }
+
+        sockaddr_in* inet = reinterpret_cast<sockaddr_in*>(&storage);
+        inet->sin_family = AF_INET;
+        inet->sin_port = htons(address.port);
+        inet->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        length = sizeof(sockaddr_in);
+        return socket(AF_INET, SOCK_STREAM, 0);
+    }
+
+    /**
+     * Connect to the address.
+     *
+     * @return The connected socket, or -1 with errno set.
+     */
+    inline int connect(const Address& address)
+    {
+        sockaddr_storage storage;
+        socklen_t length;
+        int fd = open(address, storage, length);
+        if (fd < 0) {
+            return -1;
+        }
+
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&storage), length) != 0) {
+            int error = errno;
+            close(fd);
+            errno = error;
+            return -1;
+        }
+
+        return fd;
+    }
+
+    /**
+     * Listen on the address, replacing any stale unix socket file.
+     * A unix socket another server is listening on, or some other file at the path,
+     * makes listening fail rather than being removed.
+     *
+     * @return The listening socket, or -1 with errno set.
+     */
+    inline int listen(const Address& address)
+    {
+        if (!address.is_set()) {
+            errno = EINVAL;
+            return -1;
+        }
+
+        sockaddr_storage storage;
+        socklen_t length;
+        int fd = open(address, storage, length);
+        if (fd < 0) {
+            return -1;
+        }
+
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        //A unix socket is only stale if nothing accepts connections on it, a running server keeps it's path.
+        if (!address.path.empty()) {
+            int existing = connect(address);
+            if (existing >= 0) {
+                close(existing);
+                close(fd);
+                errno = EADDRINUSE;
+                return -1;
+            }
+            if (errno == ECONNREFUSED) {
+                address.remove();
+            }
+        }
+
+        if (bind(fd, reinterpret_cast<sockaddr*>(&storage), length) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+            int error = errno;
+            close(fd);
+            errno = error;
+            return -1;
+        }
+
+        return fd;
+    }
+
+    /**
+     * Send pipelined messages as soon as they're written rather than waiting to fill a packet.
+     * Does nothing to unix sockets.
+     */
+    inline void set_no_delay(int fd)
+    {
+        int no_delay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+    }
+
+    /**
+     * Make sends that can't make progress for the given time fail rather than block.
+     */
+    inline void set_send_timeout(int fd, unsigned seconds)
+    {
+        timeval timeout = {static_cast<time_t>(seconds), 0};
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    }
+
+    /**
+     * Read exactly size bytes.
+     *
+     * @return false if the connection closed or failed first.
+     */
+    inline bool read_fully(int fd, void* buffer, size_t size)
+    {
+        uint8_t* bytes = static_cast<uint8_t*>(buffer);
+        while (size > 0) {
+            ssize_t received = recv(fd, bytes, size, 0);
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            if (received <= 0) {
+                return false;
+            }
+            bytes += received;
+            size -= received;
+        }
+        return true;
+    }
+
+    /**
+     * Write exactly size bytes, a closed connection fails rather than raising SIGPIPE.
+     *
+     * @return false if the connection closed, failed or hit it's send timeout first.
+     */
+    inline bool write_fully(int fd, const void* buffer, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(buffer);
+        while (size > 0) {
+            ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+            if (sent <= 0) {
+                return false;
+            }
+            bytes += sent;
+            size -= sent;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,461 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "definitions.hh"
+#include "Bitplane.hh"
+#include "NeighbourTable.hh"
+#include "SeededMines.hh"
+
+namespace Casspir
+{
+    /**
+     * A board of a size fixed at compile time, for the standard beginner (9x9),
+     * intermediate (16x16) and expert (30x16) sizes.
+     * Everything is stored inline, so a board can sit on the stack and copying one never allocates,
+     * and neighbours come from a table made at compile time with no edge checks.
+     * It plays like Map and gives the same board from the same seed, and keeps the frontier and dirty tiles
+     * so BasicSolver can solve it in place, but has no checkpoints.
+     */
+    template <uint32_t W, uint32_t H>
+    class BasicMap
+    {
+        public:
+            static const uint64_t SIZE = static_cast<uint64_t>(W) * H;
+
+            /**
+             * Initialise an empty board, with no mines.
+             */
+            BasicMap() : values(), total_mines(0)
+            {
+                this->reset();
+            }
+
+            /**
+             * Initialise a board with the given mines.
+             *
+             * @param mines num_words() words of mine bits, as from get_mines().
+             */
+            explicit BasicMap(const uint64_t* mines) : values()
+            {
+                this->mines.assign(mines);
+                this->compute_values();
+                this->total_mines = this->mines.count();
+                this->reset();
+            }
+
+            /**
+             * Replace the board with exactly num_mines mines placed from the given seed, and make the first flip.
+             * Gives the same layout as Map::generate_seeded.
+             *
+             * @param num_mines Mines to place, limited to the tiles available.
+             * @param first_flip Coordinate of the players first move.
+             * @param seed Seed for the mine placements.
+             */
+            void generate_seeded(uint64_t num_mines, Point first_flip, uint64_t seed)
+            {
+                this->mines.clear();
+
+                uint64_t first_flip_index = first_flip.get_index(W);
+                assert (first_flip_index < SIZE);
+                this->total_mines = SeededMines::place(
+                    this->mines,
+                    SIZE,
+                    first_flip_index,
+                    this->get_neighbours(first_flip_index),
+                    num_mines,
+                    seed
+                );
+                this->compute_values();
+
+                this->reset();
+
+                //Flip the first tile
+                this->flood_fill(first_flip_index);
+                this->check_completed();
+            }
+
+            /**
+             * If the tile is unflipped, flip it and adjoining tiles recusively while tile value is non zero.
+             * If the tile is flipped, expand adjoining unflipped tiles.
+             *
+             * @param position
+             *
+             * @return The number of tiles flipped.
+             */
+            uint64_t flip(Point position)
+            {
+                uint64_t index = position.get_index(W);
+                assert (index < SIZE);
+                uint64_t flipped = 0;
+
+                if (this->is_flipped(index)) {
+                    if (this->is_tile_satisfied(index)) {
+                        const uint16_t* entry = neighbour_table.entries[index];
+                        for (uint16_t n = 1; n <= entry[0]; n++) {
+                            flipped += this->flood_fill(entry[n]);
+                        }
+                    }
+                } else if (!this->is_flagged(index)) {
+                    flipped = this->flood_fill(index);
+                }
+
+                this->check_completed();
+
+                return flipped;
+            }
+
+            /**
+             * Flag the given position as a mine, or unflag it if it's already flagged.
+             *
+             * @param position
+             */
+            void flag(Point position)
+            {
+                if (this->status != MapStatus::IN_PROGRESS) {
+                    return;
+                }
+
+                uint64_t index = position.get_index(W);
+                assert (index < SIZE);
+                if (!this->is_flipped(index)) {
+                    if (this->is_flagged(index)) {
+                        this->flagged.unset(index);
+                        this->mines_remaining += 1;
+                    } else if (this->mines_remaining > 0) {
+                        this->flagged.set(index);
+                        this->mines_remaining -= 1;
+                    }
+                    this->touch(index);
+                }
+
+                this->check_completed();
+            }
+
+            /**
+             * Reset the puzzle to the initial state, undoing the first flip too.
+             */
+            void reset()
+            {
+                this->flipped.clear();
+                this->flagged.clear();
+                this->frontier.clear();
+                this->dirty.clear();
+                this->mines_remaining = this->total_mines;
+                this->tiles_flipped = 0;
+                this->status = MapStatus::IN_PROGRESS;
+            }
+
+            uint32_t get_width() const
+            {
+                return W;
+            }
+
+            uint32_t get_height() const
+            {
+                return H;
+            }
+
+            uint64_t get_size() const
+            {
+                return SIZE;
+            }
+
+            uint64_t get_num_flipped() const
+            {
+                return this->tiles_flipped;
+            }
+
+            uint64_t get_mines_remaining() const
+            {
+                return this->mines_remaining;
+            }
+
+            uint64_t get_total_mines() const
+            {
+                return this->total_mines;
+            }
+
+            MapStatus get_status() const
+            {
+                return this->status;
+            }
+
+            TileState get_tile(Point position) const
+            {
+                return this->get_tile(position.get_index(W));
+            }
+
+            TileState get_tile(uint64_t index) const
+            {
+                assert (index < SIZE);
+                return TileState(
+                    this->get_value(index),
+                    this->is_mine(index),
+                    this->is_flagged(index),
+                    this->is_flipped(index)
+                );
+            }
+
+            bool is_mine(uint64_t index) const
+            {
+                return this->mines.get(index);
+            }
+
+            bool is_flagged(uint64_t index) const
+            {
+                return this->flagged.get(index);
+            }
+
+            bool is_flipped(uint64_t index) const
+            {
+                return this->flipped.get(index);
+            }
+
+            uint8_t get_value(uint64_t index) const
+            {
+                return this->values[index];
+            }
+
+            bool is_frontier(uint64_t index) const
+            {
+                return this->frontier.get(index);
+            }
+
+            const FixedBitplane<SIZE>& get_mines() const
+            {
+                return this->mines;
+            }
+
+            const FixedBitplane<SIZE>& get_flagged() const
+            {
+                return this->flagged;
+            }
+
+            const FixedBitplane<SIZE>& get_flipped() const
+            {
+                return this->flipped;
+            }
+
+            const FixedBitplane<SIZE>& get_frontier() const
+            {
+                return this->frontier;
+            }
+
+            /**
+             * Move the dirty frontier tiles into the given list, in ascending order, as Map does.
+             *
+             * @param tiles A list to fill, any existing contents are discarded.
+             */
+            void take_dirty_tiles(std::vector<uint64_t>& tiles)
+            {
+                tiles.clear();
+                for (uint64_t w = 0; w < this->dirty.num_words(); w++) {
+                    for (uint64_t bits = this->dirty.word(w); bits != 0; bits &= bits - 1) {
+                        tiles.push_back(w * 64 + __builtin_ctzll(bits));
+                    }
+                }
+                this->dirty.clear();
+            }
+
+            /**
+             * Mark the whole frontier dirty, for consumers that haven't seen it yet.
+             */
+            void mark_frontier_dirty()
+            {
+                this->dirty = this->frontier;
+            }
+
+            /**
+             * Check whether the tile's value is matched by the number of flagged neighbours.
+             *
+             * @param index
+             *
+             * @return true if satisfied.
+             */
+            bool is_tile_satisfied(uint64_t index) const
+            {
+                const uint16_t* entry = neighbour_table.entries[index];
+                uint8_t flags = 0;
+                for (uint16_t n = 1; n <= entry[0]; n++) {
+                    flags += this->is_flagged(entry[n]);
+                }
+                return flags == this->get_value(index);
+            }
+
+            /**
+             * Find the neighbour indices of a tile, in ascending order.
+             *
+             * @param index The tile index to find neighbours for.
+             */
+            Neighbours get_neighbours(uint64_t index) const
+            {
+                const uint16_t* entry = neighbour_table.entries[index];
+                Neighbours neighbours;
+                for (uint16_t n = 1; n <= entry[0]; n++) {
+                    neighbours.push(entry[n]);
+                }
+                return neighbours;
+            }
+
+        private:
+            static constexpr NeighbourTable<W, H> neighbour_table = NeighbourTable<W, H>();
+
+            FixedBitplane<SIZE> mines, flagged, flipped;
+            std::array<uint8_t, SIZE> values;
+
+            //Flipped numbered tiles with unflipped, unflagged neighbours,
+            //and those whose neighbourhood changed since they were last taken, a bit each so they're never repeated.
+            FixedBitplane<SIZE> frontier, dirty;
+
+            uint64_t total_mines, mines_remaining, tiles_flipped;
+            MapStatus status;
+
+            /**
+             * Count every tile's neighbouring mines, by adding each mine to it's neighbours.
+             */
+            void compute_values()
+            {
+                this->values.fill(0);
+                for (uint64_t w = 0; w < this->mines.num_words(); w++) {
+                    for (uint64_t bits = this->mines.word(w); bits != 0; bits &= bits - 1) {
+                        const uint16_t* entry = neighbour_table.entries[w * 64 + __builtin_ctzll(bits)];
+                        for (uint16_t n = 1; n <= entry[0]; n++) {
+                            this->values[entry[n]]++;
+                        }
+                    }
+                }
+            }
+
+            /**
+             * Flip a tile, flooding through zero valued tiles from it.
+             * The flood's stack is on the stack too, each tile goes on it at most once.
+             *
+             * @param index
+             *
+             * @return The number of tiles flipped.
+             */
+            uint64_t flood_fill(uint64_t index)
+            {
+                if (this->status != MapStatus::IN_PROGRESS) {
+                    return 0;
+                }
+
+                if (this->is_flipped(index) || this->is_flagged(index)) {
+                    return 0;
+                }
+
+                this->flipped.set(index);
+                this->tiles_flipped++;
+
+                if (this->is_mine(index)) {
+                    this->status = MapStatus::FAILED;
+                    this->touch(index);
+                    return 1;
+                }
+
+                if (this->get_value(index) != 0) {
+                    this->touch(index);
+                    return 1;
+                }
+
+                //Neighbours of a zero tile are never mines, so the game can't fail from here.
+                std::array<uint16_t, SIZE> stack;
+                uint64_t stack_size = 0;
+                uint64_t flipped = 1;
+                stack[stack_size++] = index;
+                while (stack_size > 0) {
+                    const uint16_t* entry = neighbour_table.entries[stack[--stack_size]];
+                    for (uint16_t n = 1; n <= entry[0]; n++) {
+                        uint16_t neighbour = entry[n];
+                        if (this->is_flipped(neighbour)) {
+                            //A revealed number may have just lost it's last open neighbour.
+                            if (this->is_frontier(neighbour)) {
+                                this->refresh_frontier(neighbour);
+                            }
+                            continue;
+                        }
+
+                        if (this->is_flagged(neighbour)) {
+                            continue;
+                        }
+
+                        this->flipped.set(neighbour);
+                        flipped++;
+                        if (this->get_value(neighbour) == 0) {
+                            stack[stack_size++] = neighbour;
+                        } else {
+                            this->touch(neighbour);
+                        }
+                    }
+                }
+                this->tiles_flipped += flipped - 1;
+
+                return flipped;
+            }
+
+            /**
+             * Recompute whether a tile is on the frontier, marking it dirty if it is.
+             *
+             * @param index
+             */
+            void refresh_frontier(uint64_t index)
+            {
+                bool is_frontier = false;
+                if (this->is_flipped(index) && !this->is_mine(index) && this->get_value(index) > 0) {
+                    const uint16_t* entry = neighbour_table.entries[index];
+                    for (uint16_t n = 1; n <= entry[0]; n++) {
+                        if (!this->is_flipped(entry[n]) && !this->is_flagged(entry[n])) {
+                            is_frontier = true;
+                            break;
+                        }
+                    }
+                }
+
+                this->frontier.set(index, is_frontier);
+                if (is_frontier) {
+                    this->dirty.set(index);
+                }
+            }
+
+            /**
+             * Refresh the frontier around a tile that was just flipped or flagged.
+             *
+             * @param index
+             */
+            void touch(uint64_t index)
+            {
+                this->refresh_frontier(index);
+                const uint16_t* entry = neighbour_table.entries[index];
+                for (uint16_t n = 1; n <= entry[0]; n++) {
+                    if (this->is_flipped(entry[n])) {
+                        this->refresh_frontier(entry[n]);
+                    }
+                }
+            }
+
+            /**
+             * Checks whether the game has been completed.
+             */
+            void check_completed()
+            {
+                if (this->status != MapStatus::IN_PROGRESS) {
+                    return;
+                }
+
+                if (this->mines_remaining == 0 && this->tiles_flipped + this->total_mines == SIZE) {
+                    this->status = MapStatus::COMPLETE;
+                }
+            }
+    };
+
+    template <uint32_t W, uint32_t H>
+    constexpr NeighbourTable<W, H> BasicMap<W, H>::neighbour_table;
+
+    typedef BasicMap<9, 9> BeginnerMap;
+    typedef BasicMap<16, 16> IntermediateMap;
+    typedef BasicMap<30, 16> ExpertMap;
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Casspir
+{
+    /**
+     * A fixed size array of bits packed into 64 bit words.
+     * Bits past the end of the plane are always zero.
+     */
+    class Bitplane
+    {
+        public:
+            Bitplane(uint64_t size = 0)
+            {
+                this->resize(size);
+            }
+
+            void resize(uint64_t size)
+            {
+                this->bits = size;
+                this->words.assign((size + 63) / 64, 0);
+            }
+
+            uint64_t size() const
+            {
+                return this->bits;
+            }
+
+            uint64_t num_words() const
+            {
+                return this->words.size();
+            }
+
+            uint64_t word(uint64_t word_index) const
+            {
+                return this->words[word_index];
+            }
+
+            /**
+             * Mask of the valid bits in the given word.
+             */
+            uint64_t word_mask(uint64_t word_index) const
+            {
+                uint64_t remaining = this->bits - word_index * 64;
+                return remaining >= 64 ? ~0ULL : (1ULL << remaining) - 1;
+            }
+
+            bool get(uint64_t index) const
+            {
+                return (this->words[index >> 6] >> (index & 63)) & 1;
+            }
+
+            void set(uint64_t index)
+            {
+                this->words[index >> 6] |= 1ULL << (index & 63);
+            }
+
+            void unset(uint64_t index)
+            {
+                this->words[index >> 6] &= ~(1ULL << (index & 63));
+            }
+
+            void toggle(uint64_t index)
+            {
+                this->words[index >> 6] ^= 1ULL << (index & 63);
+            }
+
+            void set(uint64_t index, bool value)
+            {
+                if (value) {
+                    this->set(index);
+                } else {
+                    this->unset(index);
+                }
+            }
+
+            /**
+             * Copy num_words() words into the plane, any bits past the end are dropped.
+             */
+            void assign(const uint64_t* words)
+            {
+                for (uint64_t w = 0; w < this->words.size(); w++) {
+                    this->words[w] = words[w] & this->word_mask(w);
+                }
+            }
+
+            void clear()
+            {
+                std::fill(this->words.begin(), this->words.end(), 0);
+            }
+
+            /**
+             * Count the set bits.
+             */
+            uint64_t count() const
+            {
+                uint64_t total = 0;
+                for (uint64_t word : this->words) {
+                    total += __builtin_popcountll(word);
+                }
+                return total;
+            }
+
+            /**
+             * Approximate number of bytes held by the plane.
+             */
+            uint64_t memory_usage() const
+            {
+                return this->words.size() * sizeof(uint64_t);
+            }
+
+        private:
+            uint64_t bits;
+            std::vector<uint64_t> words;
+    };
+
+    /**
+     * A bitplane of a size fixed at compile time, stored inline rather than on the heap.
+     * Bits past the end of the plane are always zero.
+     */
+    template <uint64_t BITS>
+    class FixedBitplane
+    {
+        public:
+            static const uint64_t WORDS = (BITS + 63) / 64;
+
+            FixedBitplane() : words() {}
+
+            uint64_t size() const
+            {
+                return BITS;
+            }
+
+            uint64_t num_words() const
+            {
+                return WORDS;
+            }
+
+            uint64_t word(uint64_t word_index) const
+            {
+                return this->words[word_index];
+            }
+
+            /**
+             * Mask of the valid bits in the given word.
+             */
+            uint64_t word_mask(uint64_t word_index) const
+            {
+                uint64_t remaining = BITS - word_index * 64;
+                return remaining >= 64 ? ~0ULL : (1ULL << remaining) - 1;
+            }
+
+            bool get(uint64_t index) const
+            {
+                return (this->words[index >> 6] >> (index & 63)) & 1;
+            }
+
+            void set(uint64_t index)
+            {
+                this->words[index >> 6] |= 1ULL << (index & 63);
+            }
+
+            void unset(uint64_t index)
+            {
+                this->words[index >> 6] &= ~(1ULL << (index & 63));
+            }
+
+            void set(uint64_t index, bool value)
+            {
+                if (value) {
+                    this->set(index);
+                } else {
+                    this->unset(index);
+                }
+            }
+
+            /**
+             * Copy num_words() words into the plane, any bits past the end are dropped.
+             */
+            void assign(const uint64_t* words)
+            {
+                for (uint64_t w = 0; w < WORDS; w++) {
+                    this->words[w] = words[w] & this->word_mask(w);
+                }
+            }
+
+            void clear()
+            {
+                this->words.fill(0);
+            }
+
+            /**
+             * Count the set bits.
+             */
+            uint64_t count() const
+            {
+                uint64_t total = 0;
+                for (uint64_t word : this->words) {
+                    total += __builtin_popcountll(word);
+                }
+                return total;
+            }
+
+        private:
+            std::array<uint64_t, WORDS> words;
+    };
+}
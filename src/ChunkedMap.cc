@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "ChunkedMap.hh"
+#include "Random.hh"
+
+using namespace Casspir;
+
+//Chunk rows are single words, and coordinates are split into chunk and offset by shifting.
+static_assert(ChunkedMap::CHUNK_SIZE == 64, "Chunk rows must be 64 bit words");
+
+const int64_t ChunkedMap::CHUNK_SIZE;
+const uint32_t ChunkedMap::MIN_MINES_PER_CHUNK;
+const int64_t ChunkedMap::MIN_COORDINATE;
+const int64_t ChunkedMap::MAX_COORDINATE;
+
+/**
+ * Start a map and make the first flip, which is always an opening.
+ *
+ * @param seed Seed for every chunk's mines.
+ * @param mines_per_chunk Mines placed in each chunk, clamped to MIN_MINES_PER_CHUNK up to the chunk's tiles.
+ * @param first_x Coordinate of the players first move, MIN_COORDINATE to MAX_COORDINATE.
+ * @param first_y
+ */
+ChunkedMap::ChunkedMap(uint64_t seed, uint32_t mines_per_chunk, int64_t first_x, int64_t first_y)
+    : seed(seed), first_x(first_x), first_y(first_y)
+{
+    //Clamped rather than asserted, a sparser map could flood fill without end.
+    this->mines_per_chunk = std::min<uint32_t>(std::max(mines_per_chunk, MIN_MINES_PER_CHUNK), CHUNK_SIZE * CHUNK_SIZE);
+
+    this->status = MapStatus::IN_PROGRESS;
+    this->tiles_flipped = 0;
+    this->flip(first_x, first_y);
+}
+
+/**
+ * If the tile is unflipped, flip it and flood outwards while the tile value is zero.
+ * If the tile is flipped, expand adjoining unflipped tiles if it's number is satisfied by flags.
+ *
+ * @param x
+ * @param y
+ *
+ * @return The number of tiles flipped.
+ */
+uint64_t ChunkedMap::flip(int64_t x, int64_t y)
+{
+    if (this->status != MapStatus::IN_PROGRESS || !in_bounds(x, y)) {
+        return 0;
+    }
+
+    uint64_t flipped = 0;
+    if (this->is_flipped(x, y)) {
+        uint8_t flags = 0;
+        for (int64_t dy = -1; dy <= 1; dy++) {
+            for (int64_t dx = -1; dx <= 1; dx++) {
+                flags += this->is_flagged(x + dx, y + dy);
+            }
+        }
+
+        if (flags == this->get_value(x, y)) {
+            for (int64_t dy = -1; dy <= 1; dy++) {
+                for (int64_t dx = -1; dx <= 1; dx++) {
+                    flipped += this->flood_fill(x + dx, y + dy);
+                }
+            }
+        }
+    } else if (!this->is_flagged(x, y)) {
+        flipped = this->flood_fill(x, y);
+    }
+
+    return flipped;
+}
+
+/**
+ * Toggle a flag on an unflipped tile.
+ *
+ * @param x
+ * @param y
+ */
+void ChunkedMap::flag(int64_t x, int64_t y)
+{
+    if (this->status != MapStatus::IN_PROGRESS || !in_bounds(x, y) || this->is_flipped(x, y)) {
+        return;
+    }
+
+    Chunk& chunk = this->get_chunk(x, y);
+    chunk.flagged[y & 63] ^= 1ULL << (x & 63);
+}
+
+/**
+ * Get the state of a tile, generating it's chunk, and those around it if it's on a chunk edge.
+ *
+ * @param x
+ * @param y
+ *
+ * @return The tile's state, empty outside MIN_COORDINATE to MAX_COORDINATE.
+ */
+TileState ChunkedMap::get_tile(int64_t x, int64_t y)
+{
+    if (!in_bounds(x, y)) {
+        return TileState();
+    }
+
+    return TileState(
+        this->get_value(x, y),
+        this->is_mine(x, y),
+        this->is_flagged(x, y),
+        this->is_flipped(x, y)
+    );
+}
+
+/**
+ * Get the status of the game, it's never complete.
+ *
+ * @return status
+ */
+MapStatus ChunkedMap::get_status()
+{
+    return this->status;
+}
+
+/**
+ * Get the number of tiles flipped.
+ *
+ * @return tiles flipped
+ */
+uint64_t ChunkedMap::get_num_flipped()
+{
+    return this->tiles_flipped;
+}
+
+/**
+ * Get the number of chunks generated so far.
+ *
+ * @return chunks
+ */
+uint64_t ChunkedMap::get_num_chunks()
+{
+    return this->chunks.size();
+}
+
+/**
+ * Approximate number of bytes held by the map, which grows with the area explored.
+ *
+ * @return bytes
+ */
+uint64_t ChunkedMap::get_memory_usage()
+{
+    return sizeof(*this)
+        + this->chunks.size() * (sizeof(Chunk) + sizeof(std::pair< const ChunkKey, std::unique_ptr<Chunk> >) + sizeof(void*))
+        + this->chunks.bucket_count() * sizeof(void*)
+        + this->flood_stack.capacity() * sizeof(std::pair<int64_t, int64_t>);
+}
+
+/**
+ * Whether a tile exists.
+ *
+ * @param x
+ * @param y
+ *
+ * @return Whether both coordinates are MIN_COORDINATE to MAX_COORDINATE.
+ */
+bool ChunkedMap::in_bounds(int64_t x, int64_t y)
+{
+    return x >= MIN_COORDINATE && x <= MAX_COORDINATE && y >= MIN_COORDINATE && y <= MAX_COORDINATE;
+}
+
+/**
+ * Mix both whole chunk coordinates into one value, for finding the chunk and seeding it's mines.
+ *
+ * @param chunk_x
+ * @param chunk_y
+ *
+ * @return hash
+ */
+uint64_t ChunkedMap::hash_chunk(int64_t chunk_x, int64_t chunk_y)
+{
+    uint64_t hash = static_cast<uint64_t>(chunk_x) * 0x9e3779b97f4a7c15ULL;
+    hash = (hash ^ (hash >> 32) ^ static_cast<uint64_t>(chunk_y)) * 0xbf58476d1ce4e5b9ULL;
+    return hash ^ (hash >> 31);
+}
+
+/**
+ * Find the chunk holding a tile, generating it if it's new.
+ *
+ * @param x
+ * @param y
+ *
+ * @return The chunk, which stays put for the life of the map.
+ */
+ChunkedMap::Chunk& ChunkedMap::get_chunk(int64_t x, int64_t y)
+{
+    assert (in_bounds(x, y));
+    int64_t chunk_x = x >> 6;
+    int64_t chunk_y = y >> 6;
+
+    std::unique_ptr<Chunk>& chunk = this->chunks[ChunkKey(chunk_x, chunk_y)];
+    if (!chunk) {
+        chunk.reset(new Chunk());
+        this->generate(*chunk, chunk_x, chunk_y);
+    }
+
+    return *chunk;
+}
+
+/**
+ * Place a chunk's mines, using Floyd's algorithm to pick exactly mines_per_chunk tiles.
+ * Mines in the first flip's neighbourhood are removed afterwards.
+ *
+ * @param chunk A new, empty, chunk.
+ * @param chunk_x The chunk's coordinate in chunks.
+ * @param chunk_y
+ */
+void ChunkedMap::generate(Chunk& chunk, int64_t chunk_x, int64_t chunk_y)
+{
+    Random random(this->seed ^ hash_chunk(chunk_x, chunk_y));
+
+    const uint64_t tiles = CHUNK_SIZE * CHUNK_SIZE;
+    for (uint64_t j = tiles - this->mines_per_chunk; j < tiles; j++) {
+        uint64_t tile = random.below(j + 1);
+        if ((chunk.mines[tile >> 6] >> (tile & 63)) & 1) {
+            tile = j;
+        }
+        chunk.mines[tile >> 6] |= 1ULL << (tile & 63);
+    }
+
+    //Keep the first flip's neighbourhood clear.
+    if (!in_bounds(this->first_x, this->first_y)) {
+        return;
+    }
+    for (int64_t y = this->first_y - 1; y <= this->first_y + 1; y++) {
+        for (int64_t x = this->first_x - 1; x <= this->first_x + 1; x++) {
+            if ((x >> 6) == chunk_x && (y >> 6) == chunk_y) {
+                chunk.mines[y & 63] &= ~(1ULL << (x & 63));
+            }
+        }
+    }
+}
+
+//Tiles that don't exist are never mines, flagged or flipped, so the edge of the map acts like a wall.
+bool ChunkedMap::is_mine(int64_t x, int64_t y)
+{
+    return in_bounds(x, y) && (this->get_chunk(x, y).mines[y & 63] >> (x & 63)) & 1;
+}
+
+bool ChunkedMap::is_flagged(int64_t x, int64_t y)
+{
+    return in_bounds(x, y) && (this->get_chunk(x, y).flagged[y & 63] >> (x & 63)) & 1;
+}
+
+bool ChunkedMap::is_flipped(int64_t x, int64_t y)
+{
+    return in_bounds(x, y) && (this->get_chunk(x, y).flipped[y & 63] >> (x & 63)) & 1;
+}
+
+/**
+ * Count the mines around a tile.
+ * Tiles away from the chunk's edge are counted from it's own rows,
+ * otherwise the neighbouring chunks are generated as needed.
+ *
+ * @param x
+ * @param y
+ *
+ * @return 0-8
+ */
+uint8_t ChunkedMap::get_value(int64_t x, int64_t y)
+{
+    int64_t local_x = x & 63;
+    int64_t local_y = y & 63;
+
+    if (local_x > 0 && local_x < CHUNK_SIZE - 1 && local_y > 0 && local_y < CHUNK_SIZE - 1) {
+        const Chunk& chunk = this->get_chunk(x, y);
+        uint8_t value = 0;
+        for (int64_t row = local_y - 1; row <= local_y + 1; row++) {
+            value += __builtin_popcountll((chunk.mines[row] >> (local_x - 1)) & 7);
+        }
+        return value - ((chunk.mines[local_y] >> local_x) & 1);
+    }
+
+    uint8_t value = 0;
+    for (int64_t dy = -1; dy <= 1; dy++) {
+        for (int64_t dx = -1; dx <= 1; dx++) {
+            if (dx != 0 || dy != 0) {
+                value += this->is_mine(x + dx, y + dy);
+            }
+        }
+    }
+    return value;
+}
+
+/**
+ * Flip this tile, and if it's value is zero, flood outwards
+ * flipping neighbours until non-zero tiles are reached.
+ *
+ * @param x
+ * @param y
+ *
+ * @return The number of tiles flipped.
+ */
+uint64_t ChunkedMap::flood_fill(int64_t x, int64_t y)
+{
+    uint64_t flipped = 0;
+    this->flood_stack.clear();
+    this->flood_stack.emplace_back(x, y);
+
+    while (!this->flood_stack.empty()) {
+        int64_t tile_x = this->flood_stack.back().first;
+        int64_t tile_y = this->flood_stack.back().second;
+        this->flood_stack.pop_back();
+
+        if (!in_bounds(tile_x, tile_y) || this->is_flipped(tile_x, tile_y) || this->is_flagged(tile_x, tile_y)) {
+            continue;
+        }
+
+        Chunk& chunk = this->get_chunk(tile_x, tile_y);
+        chunk.flipped[tile_y & 63] |= 1ULL << (tile_x & 63);
+        this->tiles_flipped++;
+        flipped++;
+
+        if (this->is_mine(tile_x, tile_y)) {
+            this->status = MapStatus::FAILED;
+            return flipped;
+        }
+
+        if (this->get_value(tile_x, tile_y) == 0) {
+            for (int64_t dy = -1; dy <= 1; dy++) {
+                for (int64_t dx = -1; dx <= 1; dx++) {
+                    if (dx != 0 || dy != 0) {
+                        this->flood_stack.emplace_back(tile_x + dx, tile_y + dy);
+                    }
+                }
+            }
+        }
+    }
+
+    return flipped;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "definitions.hh"
+
+namespace Casspir
+{
+    /**
+     * An effectively unbounded minesweeper map, split into square chunks
+     * that are only generated when something first looks at them.
+     * Each chunk's mines come from the seed and the chunk's coordinate alone,
+     * so the same seed always gives the same map whatever order it's explored in.
+     */
+    class ChunkedMap
+    {
+        public:
+            static const int64_t CHUNK_SIZE = 64;
+
+            //Below this density openings can go on forever.
+            static const uint32_t MIN_MINES_PER_CHUNK = 410;
+
+            //Tiles outside these coordinates don't exist,
+            //which leaves room to step to the neighbours of any tile that does without overflowing.
+            static const int64_t MIN_COORDINATE = INT64_MIN + CHUNK_SIZE;
+            static const int64_t MAX_COORDINATE = INT64_MAX - CHUNK_SIZE;
+
+            ChunkedMap(uint64_t seed, uint32_t mines_per_chunk, int64_t first_x, int64_t first_y);
+
+            uint64_t flip(int64_t x, int64_t y);
+            void flag(int64_t x, int64_t y);
+
+            TileState get_tile(int64_t x, int64_t y);
+            MapStatus get_status();
+            uint64_t get_num_flipped();
+            uint64_t get_num_chunks();
+            uint64_t get_memory_usage();
+
+        private:
+            //One 64 bit word per row of the chunk.
+            struct Chunk {
+                uint64_t mines[CHUNK_SIZE];
+                uint64_t flagged[CHUNK_SIZE];
+                uint64_t flipped[CHUNK_SIZE];
+            };
+
+            uint64_t seed;
+            uint32_t mines_per_chunk;
+            int64_t first_x, first_y;
+            MapStatus status;
+            uint64_t tiles_flipped;
+
+            typedef std::pair<int64_t, int64_t> ChunkKey;
+
+            struct ChunkHash {
+                size_t operator()(const ChunkKey& key) const
+                {
+                    return ChunkedMap::hash_chunk(key.first, key.second);
+                }
+            };
+
+            std::unordered_map< ChunkKey, std::unique_ptr<Chunk>, ChunkHash > chunks;
+            std::vector< std::pair<int64_t, int64_t> > flood_stack;
+
+            static bool in_bounds(int64_t x, int64_t y);
+            static uint64_t hash_chunk(int64_t chunk_x, int64_t chunk_y);
+
+            Chunk& get_chunk(int64_t x, int64_t y);
+            void generate(Chunk& chunk, int64_t chunk_x, int64_t chunk_y);
+
+            bool is_mine(int64_t x, int64_t y);
+            bool is_flagged(int64_t x, int64_t y);
+            bool is_flipped(int64_t x, int64_t y);
+            uint8_t get_value(int64_t x, int64_t y);
+
+            uint64_t flood_fill(int64_t x, int64_t y);
+    };
+}
@@ -0,0 +1,341 @@
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Corpus.hh"
+
+using namespace Casspir;
+
+/**
+ * Start without a file.
+ */
+CorpusWriter::CorpusWriter()
+{
+}
+
+/**
+ * Finish the file if it's still open.
+ */
+CorpusWriter::~CorpusWriter()
+{
+    if (this->file.is_open()) {
+        this->close();
+    }
+}
+
+/**
+ * Create a corpus file, replacing any existing file.
+ *
+ * @param path
+ *
+ * @return false if the file couldn't be created.
+ */
+bool CorpusWriter::open(const std::string& path)
+{
+    this->offsets.clear();
+    this->file.open(path, std::ios::binary | std::ios::trunc);
+
+    //The header is filled in on close.
+    CorpusFormat::Header header = CorpusFormat::Header();
+    this->file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    return this->file.good();
+}
+
+/**
+ * Append a board.
+ *
+ * @param map The board, only it's mines are stored.
+ * @param click Coordinate of the players first move.
+ * @param operations Optional solution, each encoded with Operation::encode.
+ *
+ * @return false if writing failed.
+ */
+bool CorpusWriter::add(Map& map, Point click, const std::vector<uint64_t>& operations)
+{
+    this->offsets.push_back(this->file.tellp());
+
+    CorpusFormat::BoardHeader header = CorpusFormat::BoardHeader();
+    header.width = map.get_width();
+    header.height = map.get_height();
+    header.click_x = click.x;
+    header.click_y = click.y;
+    header.num_operations = operations.size();
+    this->file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const Bitplane& mines = map.get_mines();
+    for (uint64_t w = 0; w < mines.num_words(); w++) {
+        uint64_t word = mines.word(w);
+        this->file.write(reinterpret_cast<const char*>(&word), sizeof(word));
+    }
+
+    this->file.write(reinterpret_cast<const char*>(operations.data()), operations.size() * sizeof(uint64_t));
+
+    return this->file.good();
+}
+
+/**
+ * Write the index and header and close the file.
+ *
+ * @return false if writing failed.
+ */
+bool CorpusWriter::close()
+{
+    CorpusFormat::Header header;
+    std::memcpy(header.magic, CorpusFormat::MAGIC, sizeof(header.magic));
+    header.version = CorpusFormat::FORMAT_VERSION;
+    header.count = this->offsets.size();
+    header.index_offset = this->file.tellp();
+
+    this->file.write(reinterpret_cast<const char*>(this->offsets.data()), this->offsets.size() * sizeof(uint64_t));
+    this->file.seekp(0);
+    this->file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    bool good = this->file.good();
+    this->file.close();
+    return good;
+}
+
+/**
+ * Start without a file.
+ */
+CorpusReader::CorpusReader() : data(nullptr), length(0), count(0), index(nullptr)
+{
+}
+
+/**
+ * Unmap the file.
+ */
+CorpusReader::~CorpusReader()
+{
+    this->close();
+}
+
+/**
+ * Map a corpus file into memory.
+ *
+ * @param path
+ *
+ * @return false if the file couldn't be read or isn't a valid corpus.
+ */
+bool CorpusReader::open(const std::string& path)
+{
+    this->close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(CorpusFormat::Header))) {
+        ::close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+
+    this->data = static_cast<const uint8_t*>(mapped);
+    this->length = status.st_size;
+
+    if (!this->validate()) {
+        this->close();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Unmap the file, maps already read from it are unaffected.
+ */
+void CorpusReader::close()
+{
+    if (this->data != nullptr) {
+        munmap(const_cast<uint8_t*>(this->data), this->length);
+    }
+
+    this->data = nullptr;
+    this->length = 0;
+    this->count = 0;
+    this->index = nullptr;
+}
+
+/**
+ * Check the header and that every board lies within the file.
+ *
+ * @return false if the file isn't a valid corpus of this version.
+ */
+bool CorpusReader::validate()
+{
+    const CorpusFormat::Header* header = reinterpret_cast<const CorpusFormat::Header*>(this->data);
+    if (std::memcmp(header->magic, CorpusFormat::MAGIC, sizeof(header->magic)) != 0
+    || header->version != CorpusFormat::FORMAT_VERSION
+    || header->index_offset % 8 != 0
+    || header->index_offset > this->length
+    || header->count > (this->length - header->index_offset) / sizeof(uint64_t)
+    ) {
+        return false;
+    }
+
+    this->count = header->count;
+    this->index = reinterpret_cast<const uint64_t*>(this->data + header->index_offset);
+
+    //Checked by subtracting from the known good sizes, as adding to values from the file could overflow.
+    if (header->index_offset < sizeof(CorpusFormat::BoardHeader)) {
+        return this->count == 0;
+    }
+
+    for (uint64_t board = 0; board < this->count; board++) {
+        uint64_t offset = this->index[board];
+        if (offset % 8 != 0 || offset > header->index_offset - sizeof(CorpusFormat::BoardHeader)) {
+            return false;
+        }
+
+        const CorpusFormat::BoardHeader& board_header = this->get_header(board);
+        uint64_t size = static_cast<uint64_t>(board_header.width) * board_header.height;
+        uint64_t mine_words = (size + 63) / 64;
+        uint64_t remaining_words = (header->index_offset - offset - sizeof(CorpusFormat::BoardHeader)) / sizeof(uint64_t);
+        if (board_header.click_x >= board_header.width
+        || board_header.click_y >= board_header.height
+        || mine_words > remaining_words
+        || board_header.num_operations > remaining_words - mine_words
+        ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Get the number of boards.
+ *
+ * @return count
+ */
+uint64_t CorpusReader::size()
+{
+    return this->count;
+}
+
+/**
+ * Get a board's width.
+ *
+ * @param board 0 to size()-1
+ *
+ * @return width
+ */
+uint32_t CorpusReader::get_width(uint64_t board)
+{
+    return this->get_header(board).width;
+}
+
+/**
+ * Get a board's height.
+ *
+ * @param board 0 to size()-1
+ *
+ * @return height
+ */
+uint32_t CorpusReader::get_height(uint64_t board)
+{
+    return this->get_header(board).height;
+}
+
+/**
+ * Get the first move made on a board.
+ *
+ * @param board 0 to size()-1
+ *
+ * @return click
+ */
+Point CorpusReader::get_click(uint64_t board)
+{
+    const CorpusFormat::BoardHeader& header = this->get_header(board);
+    return Point(header.click_x, header.click_y);
+}
+
+/**
+ * Get a board's mine bitmap, in place in the mapped file.
+ *
+ * @param board 0 to size()-1
+ *
+ * @return One bit per tile in index order, packed into 64 bit words.
+ */
+const uint64_t* CorpusReader::get_mines(uint64_t board)
+{
+    return reinterpret_cast<const uint64_t*>(this->data + this->index[board] + sizeof(CorpusFormat::BoardHeader));
+}
+
+/**
+ * Build a board straight from it's mine bitmap and make the first move.
+ *
+ * @param board 0 to size()-1
+ *
+ * @return A new minesweeper map
+ */
+Map CorpusReader::get_map(uint64_t board)
+{
+    const CorpusFormat::BoardHeader& header = this->get_header(board);
+    Map map(header.width, header.height, this->get_mines(board));
+    map.flip(Point(header.click_x, header.click_y));
+    return map;
+}
+
+/**
+ * Get the number of solution operations stored with a board.
+ *
+ * @param board 0 to size()-1
+ *
+ * @return count, 0 if none were stored.
+ */
+uint64_t CorpusReader::get_num_operations(uint64_t board)
+{
+    return this->get_header(board).num_operations;
+}
+
+/**
+ * Get one of a board's solution operations.
+ *
+ * @param board 0 to size()-1
+ * @param operation 0 to get_num_operations(board)-1
+ *
+ * @return The operation.
+ */
+Operation CorpusReader::get_operation(uint64_t board, uint64_t operation)
+{
+    return Operation::decode(this->get_operations(board)[operation], this->get_width(board));
+}
+
+/**
+ * Get a board's header, in place in the mapped file.
+ *
+ * @param board 0 to size()-1
+ *
+ * @return header
+ */
+const CorpusFormat::BoardHeader& CorpusReader::get_header(uint64_t board)
+{
+    return *reinterpret_cast<const CorpusFormat::BoardHeader*>(this->data + this->index[board]);
+}
+
+/**
+ * Get a board's encoded operations, in place in the mapped file.
+ *
+ * @param board 0 to size()-1
+ *
+ * @return The operations, each encoded with Operation::encode.
+ */
+const uint64_t* CorpusReader::get_operations(uint64_t board)
+{
+    const CorpusFormat::BoardHeader& header = this->get_header(board);
+    uint64_t size = static_cast<uint64_t>(header.width) * header.height;
+    return this->get_mines(board) + (size + 63) / 64;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Map.hh"
+#include "definitions.hh"
+
+namespace Casspir
+{
+    /**
+     * Boards stored on disk, version 1, in native (little endian) byte order:
+     *
+     *   header    magic "CSPR", uint32 version, uint64 board count, uint64 index offset
+     *   boards    uint32 width, height, click x, click y, uint64 operation count,
+     *             uint64 reserved, uint64 mine bitmap words, uint64 encoded operations
+     *   index     uint64 offset of each board
+     *
+     * Everything is 8 byte aligned so it can be read in place from a mapped file.
+     */
+    namespace CorpusFormat
+    {
+        const char MAGIC[4] = {'C', 'S', 'P', 'R'};
+        const uint32_t FORMAT_VERSION = 1;
+
+        struct Header {
+            char magic[4];
+            uint32_t version;
+            uint64_t count;
+            uint64_t index_offset;
+        };
+
+        struct BoardHeader {
+            uint32_t width, height;
+            uint32_t click_x, click_y;
+            uint64_t num_operations;
+            uint64_t reserved;
+        };
+    }
+
+    /**
+     * Appends boards to a new corpus file.
+     */
+    class CorpusWriter
+    {
+        public:
+            CorpusWriter();
+            ~CorpusWriter();
+
+            bool open(const std::string& path);
+            bool add(Map& map, Point click, const std::vector<uint64_t>& operations = std::vector<uint64_t>());
+            bool close();
+
+        private:
+            std::ofstream file;
+            std::vector<uint64_t> offsets;
+    };
+
+    /**
+     * Reads boards from a memory mapped corpus file, any board can be read directly.
+     */
+    class CorpusReader
+    {
+        public:
+            CorpusReader();
+            ~CorpusReader();
+
+            CorpusReader(const CorpusReader&) = delete;
+            CorpusReader& operator=(const CorpusReader&) = delete;
+
+            bool open(const std::string& path);
+            void close();
+
+            uint64_t size();
+            uint32_t get_width(uint64_t board);
+            uint32_t get_height(uint64_t board);
+            Point get_click(uint64_t board);
+            const uint64_t* get_mines(uint64_t board);
+            Map get_map(uint64_t board);
+
+            uint64_t get_num_operations(uint64_t board);
+            Operation get_operation(uint64_t board, uint64_t operation);
+
+        private:
+            const uint8_t* data;
+            uint64_t length;
+            uint64_t count;
+            const uint64_t* index;
+
+            const CorpusFormat::BoardHeader& get_header(uint64_t board);
+            const uint64_t* get_operations(uint64_t board);
+            bool validate();
+    };
+}
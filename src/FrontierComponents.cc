@@ -0,0 +1,230 @@
+#include <algorithm>
+
+#include "FrontierComponents.hh"
+#include "BasicMap.hh"
+
+using namespace Casspir;
+
+const uint32_t FrontierComponents::NONE;
+const uint64_t FrontierComponents::EMPTY;
+
+/**
+ * Start with no components.
+ */
+FrontierComponents::FrontierComponents()
+{
+    this->cell_offsets.assign(1, 0);
+    this->number_offsets.assign(1, 0);
+}
+
+/**
+ * Split the map's current frontier into components.
+ * Components are ordered by their first border tile met scanning the frontier in index order,
+ * numbers are in index order and cells in the order they were met.
+ * Storage is kept between calls, so it only allocates when the frontier is bigger than it's been.
+ *
+ * @param map Any board with a frontier, Map or a BasicMap.
+ */
+template <typename M>
+void FrontierComponents::compute(M& map)
+{
+    //Each frontier number has at most 8 border tiles.
+    const auto& frontier = map.get_frontier();
+    this->reserve(std::min<uint64_t>(8 * frontier.count(), map.get_size()));
+
+    this->border.clear();
+    this->border_slots.clear();
+    this->parent.clear();
+    this->frontier_numbers.clear();
+    this->number_cells.clear();
+
+    //Join the open neighbours of each frontier number.
+    for (uint64_t w = 0; w < frontier.num_words(); w++) {
+        for (uint64_t bits = frontier.word(w); bits != 0; bits &= bits - 1) {
+            uint64_t number = w * 64 + __builtin_ctzll(bits);
+            uint32_t first = NONE;
+
+            for (uint64_t neighbour : map.get_neighbours(number)) {
+                if (map.is_flipped(neighbour) || map.is_flagged(neighbour)) {
+                    continue;
+                }
+
+                uint32_t id = this->find_id(neighbour);
+                if (first == NONE) {
+                    first = id;
+                } else {
+                    uint32_t a = this->find(first);
+                    uint32_t b = this->find(id);
+                    if (a != b) {
+                        this->parent[b] = a;
+                    }
+                }
+            }
+
+            if (first != NONE) {
+                this->frontier_numbers.push_back(number);
+                this->number_cells.push_back(first);
+            }
+        }
+    }
+
+    //Number the components in the order their first tiles were found, which is id order.
+    uint32_t num_border = this->border.size();
+    this->component.assign(num_border, NONE);
+    size_t num_components = 0;
+    for (uint32_t id = 0; id < num_border; id++) {
+        uint32_t root = this->find(id);
+        if (this->component[root] == NONE) {
+            this->component[root] = num_components++;
+        }
+        this->component[id] = this->component[root];
+    }
+
+    //Lay the cells and numbers out contiguously by component, counting then filling.
+    this->cell_offsets.assign(num_components + 1, 0);
+    this->number_offsets.assign(num_components + 1, 0);
+    for (uint32_t id = 0; id < num_border; id++) {
+        this->cell_offsets[this->component[id] + 1]++;
+    }
+    for (uint32_t id : this->number_cells) {
+        this->number_offsets[this->component[id] + 1]++;
+    }
+    for (size_t c = 0; c < num_components; c++) {
+        this->cell_offsets[c + 1] += this->cell_offsets[c];
+        this->number_offsets[c + 1] += this->number_offsets[c];
+    }
+
+    //Filling uses the next component's offset as each component's cursor, so it's left at the end.
+    this->cells.resize(num_border);
+    this->numbers.resize(this->frontier_numbers.size());
+    for (uint32_t id = 0; id < num_border; id++) {
+        this->cells[this->cell_offsets[this->component[id]]++] = this->border[id];
+    }
+    for (size_t i = 0; i < this->frontier_numbers.size(); i++) {
+        this->numbers[this->number_offsets[this->component[this->number_cells[i]]]++] = this->frontier_numbers[i];
+    }
+    for (size_t c = num_components; c > 0; c--) {
+        this->cell_offsets[c] = this->cell_offsets[c - 1];
+        this->number_offsets[c] = this->number_offsets[c - 1];
+    }
+    this->cell_offsets[0] = 0;
+    this->number_offsets[0] = 0;
+
+    //Leave the table empty for next time.
+    for (uint64_t slot : this->border_slots) {
+        this->slot_tiles[slot] = EMPTY;
+    }
+}
+
+//Each board the solver is built for.
+template void FrontierComponents::compute(Map& map);
+template void FrontierComponents::compute(BeginnerMap& map);
+template void FrontierComponents::compute(IntermediateMap& map);
+template void FrontierComponents::compute(ExpertMap& map);
+
+/**
+ * Get the number of components.
+ *
+ * @return size
+ */
+size_t FrontierComponents::size()
+{
+    return this->cell_offsets.size() - 1;
+}
+
+size_t FrontierComponents::get_num_cells(size_t component)
+{
+    return this->cell_offsets[component + 1] - this->cell_offsets[component];
+}
+
+/**
+ * Get the unflipped, unflagged tiles of a component.
+ *
+ * @param component
+ *
+ * @return get_num_cells(component) tile indices.
+ */
+const uint64_t* FrontierComponents::get_cells(size_t component)
+{
+    return this->cells.data() + this->cell_offsets[component];
+}
+
+size_t FrontierComponents::get_num_numbers(size_t component)
+{
+    return this->number_offsets[component + 1] - this->number_offsets[component];
+}
+
+/**
+ * Get the frontier numbers of a component, in ascending order.
+ *
+ * @param component
+ *
+ * @return get_num_numbers(component) tile indices.
+ */
+const uint64_t* FrontierComponents::get_numbers(size_t component)
+{
+    return this->numbers.data() + this->number_offsets[component];
+}
+
+/**
+ * Make sure the table can hold a border of the given size at most half full.
+ * The table is empty between calls, so it's only replaced when it grows.
+ *
+ * @param max_border The most border tiles there can be.
+ */
+void FrontierComponents::reserve(uint64_t max_border)
+{
+    uint64_t capacity = 16;
+    while (capacity < 2 * max_border) {
+        capacity *= 2;
+    }
+
+    if (this->slot_tiles.size() < capacity) {
+        this->slot_tiles.assign(capacity, EMPTY);
+        this->slot_ids.resize(capacity);
+    }
+}
+
+/**
+ * Find a border tile's id, giving it the next id in it's own set if it hasn't got one yet.
+ *
+ * @param index A border tile.
+ *
+ * @return The tile's id.
+ */
+uint32_t FrontierComponents::find_id(uint64_t index)
+{
+    //Fibonacci hashing, probing linearly from the top bits of the product.
+    uint64_t mask = this->slot_tiles.size() - 1;
+    uint64_t slot = (index * 0x9E3779B97F4A7C15ULL) >> (64 - __builtin_ctzll(this->slot_tiles.size()));
+    while (this->slot_tiles[slot] != EMPTY) {
+        if (this->slot_tiles[slot] == index) {
+            return this->slot_ids[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    uint32_t id = this->border.size();
+    this->slot_tiles[slot] = index;
+    this->slot_ids[slot] = id;
+    this->border.push_back(index);
+    this->border_slots.push_back(slot);
+    this->parent.push_back(id);
+    return id;
+}
+
+/**
+ * Find the root of a border tile's set, halving the path on the way.
+ *
+ * @param id A border tile's id.
+ *
+ * @return The root's id.
+ */
+uint32_t FrontierComponents::find(uint32_t id)
+{
+    while (this->parent[id] != id) {
+        this->parent[id] = this->parent[this->parent[id]];
+        id = this->parent[id];
+    }
+    return id;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Map.hh"
+
+namespace Casspir
+{
+    /**
+     * The frontier split into independent components.
+     * A component is the unflipped, unflagged tiles bordering the frontier that are linked
+     * through the numbers they share, along with those numbers.
+     * Found with a union-find over the border tiles, in time linear in the size of the frontier.
+     * Border tiles are given dense ids through a hash table, so the storage grows with the frontier
+     * rather than the board.
+     */
+    class FrontierComponents
+    {
+        public:
+            FrontierComponents();
+
+            template <typename M>
+            void compute(M& map);
+
+            size_t size();
+            size_t get_num_cells(size_t component);
+            const uint64_t* get_cells(size_t component);
+            size_t get_num_numbers(size_t component);
+            const uint64_t* get_numbers(size_t component);
+
+        private:
+            static const uint32_t NONE = UINT32_MAX;
+            static const uint64_t EMPTY = UINT64_MAX;
+
+            //Open addressed table from a border tile's index to it's id, a power of two in size.
+            //Only the slots of the last call's border tiles are filled, and they're emptied after.
+            std::vector<uint64_t> slot_tiles;
+            std::vector<uint32_t> slot_ids;
+
+            //Border tiles by id in the order found, with their slots and the union-find over them.
+            std::vector<uint64_t> border;
+            std::vector<uint64_t> border_slots;
+            std::vector<uint32_t> parent;
+            std::vector<uint32_t> component;
+
+            //Each frontier number with the id of one of it's border tiles.
+            std::vector<uint64_t> frontier_numbers;
+            std::vector<uint32_t> number_cells;
+
+            //Each component's tiles are cells[cell_offsets[c]..cell_offsets[c+1]), numbers likewise.
+            std::vector<uint64_t> cells, cell_offsets;
+            std::vector<uint64_t> numbers, number_offsets;
+
+            void reserve(uint64_t max_border);
+            uint32_t find_id(uint64_t index);
+            uint32_t find(uint32_t id);
+    };
+}
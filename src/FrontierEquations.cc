@@ -0,0 +1,392 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "FrontierEquations.hh"
+#include "BasicMap.hh"
+
+using namespace Casspir;
+
+const uint32_t FrontierEquations::NONE;
+
+FrontierEquations::FrontierEquations()
+{
+    this->num_rows = 0;
+    this->consistent = true;
+}
+
+/**
+ * Write out and reduce the equations of a component, and decide what tiles they can.
+ *
+ * @param map Any board, Map or a BasicMap.
+ * @param cells The component's unflipped, unflagged tiles.
+ * @param num_cells
+ * @param numbers The component's frontier numbers, every unflipped, unflagged neighbour of which is a cell.
+ * @param num_numbers
+ */
+template <typename M>
+void FrontierEquations::reduce(
+    M& map,
+    const uint64_t* cells,
+    size_t num_cells,
+    const uint64_t* numbers,
+    size_t num_numbers
+) {
+    //Columns in index order, so rows from nearby numbers share their leading columns,
+    //and a tile's column is found by searching the sorted cells.
+    this->cells.assign(cells, cells + num_cells);
+    std::sort(this->cells.begin(), this->cells.end());
+
+    //A row per number, summing it's cells to the mines it still needs.
+    if (this->rows.size() < num_numbers) {
+        this->rows.resize(num_numbers);
+    }
+    this->values.resize(num_numbers);
+    this->num_rows = num_numbers;
+    for (size_t r = 0; r < num_numbers; r++) {
+        std::vector<Term>& row = this->rows[r];
+        row.clear();
+        int64_t needed = map.get_value(numbers[r]);
+        for (uint64_t neighbour : map.get_neighbours(numbers[r])) {
+            if (map.is_flagged(neighbour)) {
+                needed--;
+            } else if (!map.is_flipped(neighbour)) {
+                uint32_t column = std::lower_bound(this->cells.begin(), this->cells.end(), neighbour) - this->cells.begin();
+                row.push_back({column, 1});
+            }
+        }
+        std::sort(row.begin(), row.end(), [](const Term& a, const Term& b) {
+            return a.column < b.column;
+        });
+        this->values[r] = needed;
+    }
+
+    this->consistent = true;
+    this->safe.clear();
+    this->mines.clear();
+
+    //Forward elimination, each column keeps the first row leading with it and clears it from the rest,
+    //which then wait on their new leading column.
+    this->waiting.assign(num_cells, NONE);
+    this->next.resize(this->num_rows);
+    for (size_t r = this->num_rows; r-- > 0;) {
+        if (!this->rows[r].empty()) {
+            uint32_t column = this->rows[r][0].column;
+            this->next[r] = this->waiting[column];
+            this->waiting[column] = r;
+        }
+    }
+
+    this->pivots.assign(num_cells, NONE);
+    for (uint32_t c = 0; c < num_cells; c++) {
+        uint32_t pivot = this->waiting[c];
+        if (pivot == NONE) {
+            continue;
+        }
+        this->pivots[c] = pivot;
+
+        uint32_t following;
+        for (uint32_t r = this->next[pivot]; r != NONE; r = following) {
+            following = this->next[r];
+            this->eliminate(r, pivot, c);
+            if (!this->rows[r].empty()) {
+                uint32_t column = this->rows[r][0].column;
+                this->next[r] = this->waiting[column];
+                this->waiting[column] = r;
+            }
+        }
+    }
+
+    //Back substitution, clearing each pivot column from the rows kept for earlier columns.
+    //Clearing a column only brings in columns without a pivot row, so the rows holding each pivot column
+    //are found once up front, and the work follows the rows' terms rather than the number of columns.
+    this->find_occurrences(true);
+    for (uint32_t c = num_cells; c-- > 0;) {
+        uint32_t pivot = this->pivots[c];
+        if (pivot == NONE || this->rows[pivot].empty()) {
+            continue;
+        }
+
+        for (uint32_t o = this->occurrence_offsets[c]; o < this->occurrence_offsets[c+1]; o++) {
+            this->eliminate(this->occurrences[o], pivot, c);
+        }
+    }
+
+    if (!this->consistent) {
+        return;
+    }
+
+    //Tiles decided by one row can leave another at it's bounds,
+    //so substitute them into the rows holding them until nothing changes.
+    this->decided.assign(num_cells, 0);
+    this->find_occurrences(false);
+    this->queue.clear();
+    this->queued.assign(this->num_rows, 0);
+    for (uint32_t c = 0; c < num_cells; c++) {
+        if (this->pivots[c] != NONE) {
+            this->queue.push_back(this->pivots[c]);
+            this->queued[this->pivots[c]] = 1;
+        }
+    }
+    for (size_t head = 0; head < this->queue.size() && this->consistent; head++) {
+        uint32_t row = this->queue[head];
+        this->queued[row] = 0;
+        this->newly_decided.clear();
+        if (!this->decide(row)) {
+            continue;
+        }
+
+        for (uint32_t column : this->newly_decided) {
+            for (uint32_t o = this->occurrence_offsets[column]; o < this->occurrence_offsets[column+1]; o++) {
+                uint32_t holding = this->occurrences[o];
+                if (!this->queued[holding]) {
+                    this->queued[holding] = 1;
+                    this->queue.push_back(holding);
+                }
+            }
+        }
+    }
+    if (!this->consistent) {
+        return;
+    }
+
+    for (uint32_t c = 0; c < num_cells; c++) {
+        if (this->decided[c] == SAFE) {
+            this->safe.push_back(this->cells[c]);
+        } else if (this->decided[c] == MINE) {
+            this->mines.push_back(this->cells[c]);
+        }
+    }
+}
+
+//Each board the solver is built for.
+template void FrontierEquations::reduce(Map& map, const uint64_t* cells, size_t num_cells, const uint64_t* numbers, size_t num_numbers);
+template void FrontierEquations::reduce(BeginnerMap& map, const uint64_t* cells, size_t num_cells, const uint64_t* numbers, size_t num_numbers);
+template void FrontierEquations::reduce(IntermediateMap& map, const uint64_t* cells, size_t num_cells, const uint64_t* numbers, size_t num_numbers);
+template void FrontierEquations::reduce(ExpertMap& map, const uint64_t* cells, size_t num_cells, const uint64_t* numbers, size_t num_numbers);
+
+/**
+ * Whether the equations can all be satisfied, if not nothing is decided.
+ *
+ * @return consistent
+ */
+bool FrontierEquations::is_consistent()
+{
+    return this->consistent;
+}
+
+/**
+ * Get the tiles that can't be mines, in index order.
+ *
+ * @return safe
+ */
+const std::vector<uint64_t>& FrontierEquations::get_safe()
+{
+    return this->safe;
+}
+
+/**
+ * Get the tiles that must be mines, in index order.
+ *
+ * @return mines
+ */
+const std::vector<uint64_t>& FrontierEquations::get_mines()
+{
+    return this->mines;
+}
+
+/**
+ * List the pivot rows holding each column, as offsets into one list.
+ *
+ * @param substitution Only list the terms back substitution clears, those after the row's leading column
+ *                     in columns with a pivot row, rather than every term.
+ */
+void FrontierEquations::find_occurrences(bool substitution)
+{
+    uint32_t num_cells = this->cells.size();
+    this->occurrence_offsets.assign(num_cells + 1, 0);
+    for (uint32_t c = 0; c < num_cells; c++) {
+        if (this->pivots[c] == NONE) {
+            continue;
+        }
+        for (const Term& term : this->rows[this->pivots[c]]) {
+            if (!substitution || (term.column != c && this->pivots[term.column] != NONE)) {
+                this->occurrence_offsets[term.column + 1]++;
+            }
+        }
+    }
+    for (uint32_t c = 0; c < num_cells; c++) {
+        this->occurrence_offsets[c + 1] += this->occurrence_offsets[c];
+    }
+
+    //Filled through the waiting list, which elimination is finished with.
+    this->occurrences.resize(this->occurrence_offsets[num_cells]);
+    this->waiting.assign(this->occurrence_offsets.begin(), this->occurrence_offsets.end() - 1);
+    for (uint32_t c = 0; c < num_cells; c++) {
+        if (this->pivots[c] == NONE) {
+            continue;
+        }
+        for (const Term& term : this->rows[this->pivots[c]]) {
+            if (!substitution || (term.column != c && this->pivots[term.column] != NONE)) {
+                this->occurrences[this->waiting[term.column]++] = this->pivots[c];
+            }
+        }
+    }
+}
+
+/**
+ * Subtract a multiple of the pivot row from another row to clear a column from it.
+ * The result is divided through by it's common factor, if it would overflow the row is dropped,
+ * which loses information but never gives a wrong answer.
+ *
+ * @param row The row to change, with a term in the column.
+ * @param pivot A row leading with the column.
+ * @param column
+ */
+void FrontierEquations::eliminate(uint32_t row, uint32_t pivot, uint32_t column)
+{
+    std::vector<Term>& target = this->rows[row];
+    const std::vector<Term>& source = this->rows[pivot];
+
+    auto found = std::lower_bound(target.begin(), target.end(), column, [](const Term& term, uint32_t c) {
+        return term.column < c;
+    });
+    if (found == target.end() || found->column != column) {
+        return;
+    }
+
+    int64_t a = source[0].coefficient;
+    int64_t b = found->coefficient;
+    int64_t common = gcd(a, b);
+    int64_t target_scale = a / common;
+    int64_t source_scale = b / common;
+
+    //Merge the two rows by column.
+    this->combined.clear();
+    bool overflow = false;
+    size_t i = 0, j = 0;
+    while (i < target.size() || j < source.size()) {
+        Term term;
+        int64_t coefficient;
+        if (j == source.size() || (i < target.size() && target[i].column < source[j].column)) {
+            term.column = target[i].column;
+            coefficient = target_scale * target[i++].coefficient;
+        } else if (i == target.size() || source[j].column < target[i].column) {
+            term.column = source[j].column;
+            coefficient = -source_scale * source[j++].coefficient;
+        } else {
+            term.column = target[i].column;
+            coefficient = target_scale * target[i++].coefficient - source_scale * source[j++].coefficient;
+        }
+
+        if (coefficient == 0) {
+            continue;
+        }
+        overflow |= std::abs(coefficient) > MAX_COEFFICIENT;
+        term.coefficient = coefficient;
+        this->combined.push_back(term);
+    }
+    int64_t value = target_scale * this->values[row] - source_scale * this->values[pivot];
+    overflow |= std::abs(value) > MAX_COEFFICIENT * static_cast<int64_t>(this->cells.size());
+
+    if (overflow) {
+        target.clear();
+        this->values[row] = 0;
+        return;
+    }
+
+    //No mines can be spread to sum to anything but 0 over no tiles.
+    if (this->combined.empty()) {
+        this->consistent &= value == 0;
+        target.clear();
+        this->values[row] = 0;
+        return;
+    }
+
+    //Keep the coefficients small, with the leading one positive.
+    int64_t divisor = 0;
+    for (const Term& term : this->combined) {
+        divisor = gcd(divisor, term.coefficient);
+    }
+    if (value % divisor != 0) {
+        this->consistent = false;
+    }
+    if (this->combined[0].coefficient < 0) {
+        divisor = -divisor;
+    }
+    for (Term& term : this->combined) {
+        term.coefficient /= divisor;
+    }
+
+    target.assign(this->combined.begin(), this->combined.end());
+    this->values[row] = value / divisor;
+}
+
+/**
+ * Take decided tiles out of a row, then decide the rest of it if it's value is at one of it's bounds.
+ * With every tile 0 or 1, a row sums to at least it's negative coefficients and at most it's positive ones,
+ * at the least the positive tiles are safe and the negative mines, and at the most the other way round.
+ *
+ * @param row
+ *
+ * @return Whether any tiles were decided.
+ */
+bool FrontierEquations::decide(uint32_t row)
+{
+    std::vector<Term>& terms = this->rows[row];
+    int64_t value = this->values[row];
+    int64_t least = 0;
+    int64_t most = 0;
+    size_t kept = 0;
+    for (const Term& term : terms) {
+        uint8_t decision = this->decided[term.column];
+        if (decision == MINE) {
+            value -= term.coefficient;
+        } else if (decision == 0) {
+            if (term.coefficient > 0) {
+                most += term.coefficient;
+            } else {
+                least += term.coefficient;
+            }
+            terms[kept++] = term;
+        }
+    }
+    terms.resize(kept);
+    this->values[row] = value;
+
+    if (value < least || value > most) {
+        this->consistent = false;
+        return false;
+    }
+    if (terms.empty() || (value != least && value != most)) {
+        return false;
+    }
+
+    for (const Term& term : terms) {
+        bool mine = (term.coefficient > 0) == (value == most);
+        this->decided[term.column] = mine ? MINE : SAFE;
+        this->newly_decided.push_back(term.column);
+    }
+    terms.clear();
+    this->values[row] = 0;
+    return true;
+}
+
+/**
+ * Greatest common divisor, always positive unless both are 0.
+ *
+ * @param a
+ * @param b
+ *
+ * @return gcd
+ */
+int64_t FrontierEquations::gcd(int64_t a, int64_t b)
+{
+    a = std::abs(a);
+    b = std::abs(b);
+    while (b != 0) {
+        int64_t remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+    return a;
+}
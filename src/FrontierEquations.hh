@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Map.hh"
+#include "definitions.hh"
+
+namespace Casspir
+{
+    /**
+     * The numbers of a frontier component as linear equations over it's unflipped tiles,
+     * one row per number with the mines it still needs on the right.
+     * Reduced by integer Gaussian elimination, then each row's 0/1 bounds decide the tiles they can.
+     * Takes polynomial time, so it works on components of any size.
+     */
+    class FrontierEquations
+    {
+        public:
+            FrontierEquations();
+
+            template <typename M>
+            void reduce(
+                M& map,
+                const uint64_t* cells,
+                size_t num_cells,
+                const uint64_t* numbers,
+                size_t num_numbers
+            );
+
+            bool is_consistent();
+            const std::vector<uint64_t>& get_safe();
+            const std::vector<uint64_t>& get_mines();
+
+        private:
+            struct Term {
+                uint32_t column;
+                int32_t coefficient;
+            };
+
+            static const uint32_t NONE = UINT32_MAX;
+
+            //Rows whose coefficients would grow past this are dropped rather than risk overflow.
+            static const int64_t MAX_COEFFICIENT = 1 << 24;
+
+            //Each column's tile, in index order.
+            std::vector<uint64_t> cells;
+
+            //Sparse rows by ascending column, and the value each sums to.
+            //Rows keep their storage between calls so reducing doesn't allocate once it's grown.
+            std::vector< std::vector<Term> > rows;
+            std::vector<int64_t> values;
+            size_t num_rows;
+            std::vector<Term> combined;
+
+            //Rows waiting for elimination, linked by leading column, and the row kept for each column.
+            std::vector<uint32_t> waiting, next;
+            std::vector<uint32_t> pivots;
+
+            //The pivot rows holding each column, occurrences[occurrence_offsets[c]] on.
+            std::vector<uint32_t> occurrence_offsets, occurrences;
+
+            //0 undecided, or SAFE or MINE, by column.
+            static const uint8_t SAFE = 1;
+            static const uint8_t MINE = 2;
+            std::vector<uint8_t> decided;
+
+            //Rows to substitute newly decided tiles into.
+            std::vector<uint32_t> queue;
+            std::vector<uint8_t> queued;
+            std::vector<uint32_t> newly_decided;
+
+            bool consistent;
+            std::vector<uint64_t> safe, mines;
+
+            void find_occurrences(bool substitution);
+            void eliminate(uint32_t row, uint32_t pivot, uint32_t column);
+            bool decide(uint32_t row);
+            static int64_t gcd(int64_t a, int64_t b);
+    };
+}
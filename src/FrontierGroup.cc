@@ -0,0 +1,462 @@
+#include <algorithm>
+
+#include "FrontierGroup.hh"
+#include "BasicMap.hh"
+
+using namespace Casspir;
+
+/**
+ * An empty group, to be built later.
+ */
+FrontierGroup::FrontierGroup()
+{
+    this->signature = 0;
+    this->enumerated = false;
+    this->exhausted = false;
+    this->work_left = 0;
+    this->mines = 0;
+    this->max_mines = 0;
+    this->solutions = 0;
+    this->assignments_tried = 0;
+}
+
+/**
+ * Copy the constraints on a group of unflipped tiles out of the map.
+ *
+ * @param map The map the group belongs to.
+ * @param cells Indices of the unflipped tiles in the group.
+ * @param numbers Indices of the flipped tiles neighbouring them.
+ */
+FrontierGroup::FrontierGroup(Map& map, const std::vector<uint64_t>& cells, const std::vector<uint64_t>& numbers)
+    : FrontierGroup()
+{
+    Scratch scratch;
+    this->build(map, cells.data(), cells.size(), numbers.data(), numbers.size(), scratch);
+}
+
+/**
+ * Replace the group with the constraints on a group of unflipped tiles, copied out of the map.
+ * Each number's constraint is reduced by the flags already placed outside the group.
+ * The group's storage is reused, so rebuilding a group doesn't allocate once it's grown.
+ *
+ * @param map The map the group belongs to, Map or a BasicMap.
+ * @param cells Indices of the unflipped tiles in the group.
+ * @param num_cells
+ * @param numbers Indices of the flipped tiles neighbouring them.
+ * @param num_numbers
+ * @param scratch Working space.
+ */
+template <typename M>
+void FrontierGroup::build(
+    M& map,
+    const uint64_t* cells,
+    size_t num_cells,
+    const uint64_t* numbers,
+    size_t num_numbers,
+    Scratch& scratch
+) {
+    std::vector<uint64_t>& sorted = scratch.sorted;
+    sorted.assign(cells, cells + num_cells);
+    std::sort(sorted.begin(), sorted.end());
+
+    //Build each number's constraint over the group, cells are identified by their position in sorted.
+    std::vector<uint32_t>& number_offsets = scratch.number_offsets;
+    std::vector<uint32_t>& number_cells = scratch.number_cells;
+    number_offsets.assign(1, 0);
+    number_cells.clear();
+    this->constraints.clear();
+    for (size_t n = 0; n < num_numbers; n++) {
+        uint64_t number = numbers[n];
+        Constraint constraint;
+        constraint.needed = map.get_value(number);
+        constraint.unassigned = 0;
+
+        for (uint64_t neighbour : map.get_neighbours(number)) {
+            auto it = std::lower_bound(sorted.begin(), sorted.end(), neighbour);
+            if (it != sorted.end() && *it == neighbour) {
+                number_cells.push_back(it - sorted.begin());
+                constraint.unassigned++;
+            } else if (map.is_flagged(neighbour)) {
+                constraint.needed--;
+            }
+        }
+
+        if (constraint.unassigned > 0) {
+            this->constraints.push_back(constraint);
+            number_offsets.push_back(number_cells.size());
+        }
+    }
+
+    //The constraints touching each cell, touching[touching_offsets[i]..touching_offsets[i+1]).
+    std::vector<uint32_t>& touching_offsets = scratch.touching_offsets;
+    std::vector<uint32_t>& touching = scratch.touching;
+    touching_offsets.assign(sorted.size() + 1, 0);
+    for (uint32_t cell : number_cells) {
+        touching_offsets[cell + 1]++;
+    }
+    for (size_t i = 0; i < sorted.size(); i++) {
+        touching_offsets[i + 1] += touching_offsets[i];
+    }
+    touching.resize(number_cells.size());
+    for (uint32_t k = 0; k < this->constraints.size(); k++) {
+        for (uint32_t i = number_offsets[k]; i < number_offsets[k+1]; i++) {
+            touching[touching_offsets[number_cells[i]]++] = k;
+        }
+    }
+
+    //Filling moved each cell's offset to the start of the next, move them back.
+    for (size_t i = sorted.size(); i > 0; i--) {
+        touching_offsets[i] = touching_offsets[i - 1];
+    }
+    touching_offsets[0] = 0;
+
+    //Order the cells breadth first through shared constraints,
+    //so every constraint fills up, and can prune, as early as possible.
+    std::vector<uint32_t>& order = scratch.order;
+    std::vector<uint8_t>& seen = scratch.seen;
+    order.clear();
+    seen.assign(sorted.size(), 0);
+    for (uint32_t start = 0; start < sorted.size(); start++) {
+        if (seen[start]) {
+            continue;
+        }
+        seen[start] = 1;
+        order.push_back(start);
+
+        for (size_t head = order.size() - 1; head < order.size(); head++) {
+            for (uint32_t t = touching_offsets[order[head]]; t < touching_offsets[order[head] + 1]; t++) {
+                uint32_t k = touching[t];
+                for (uint32_t i = number_offsets[k]; i < number_offsets[k+1]; i++) {
+                    if (!seen[number_cells[i]]) {
+                        seen[number_cells[i]] = 1;
+                        order.push_back(number_cells[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    //Lay the cells and their constraints out in assignment order.
+    this->cells.clear();
+    this->cell_constraints.clear();
+    this->cell_constraint_offsets.assign(1, 0);
+    for (uint32_t cell : order) {
+        this->cells.push_back(sorted[cell]);
+        this->cell_constraints.insert(
+            this->cell_constraints.end(),
+            touching.begin() + touching_offsets[cell],
+            touching.begin() + touching_offsets[cell + 1]
+        );
+        this->cell_constraint_offsets.push_back(this->cell_constraints.size());
+    }
+
+    //FNV-1a over everything enumerate depends on.
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](uint64_t value) {
+        hash = (hash ^ value) * 0x100000001b3ULL;
+    };
+    for (uint64_t cell : this->cells) {
+        mix(cell);
+    }
+    for (const Constraint& constraint : this->constraints) {
+        mix((static_cast<uint64_t>(static_cast<uint16_t>(constraint.needed)) << 16) | constraint.unassigned);
+    }
+    for (uint32_t k : this->cell_constraints) {
+        mix(k);
+    }
+    this->signature = hash;
+
+    this->enumerated = false;
+    this->exhausted = false;
+    this->mines = 0;
+    this->max_mines = 0;
+    this->solutions = 0;
+    this->assignments_tried = 0;
+}
+
+//Each board the solver is built for.
+template void FrontierGroup::build(Map& map, const uint64_t* cells, size_t num_cells, const uint64_t* numbers, size_t num_numbers, Scratch& scratch);
+template void FrontierGroup::build(BeginnerMap& map, const uint64_t* cells, size_t num_cells, const uint64_t* numbers, size_t num_numbers, Scratch& scratch);
+template void FrontierGroup::build(IntermediateMap& map, const uint64_t* cells, size_t num_cells, const uint64_t* numbers, size_t num_numbers, Scratch& scratch);
+template void FrontierGroup::build(ExpertMap& map, const uint64_t* cells, size_t num_cells, const uint64_t* numbers, size_t num_numbers, Scratch& scratch);
+
+/**
+ * Count every mine assignment of the cells that satisfies all the constraints,
+ * and how many of those have a mine in each cell.
+ * Counts are kept both in total and by the number of mines in the assignment.
+ * Groups with few constraints can have billions of solutions, so the search gives up
+ * once it's done max_work steps, leaving the group exhausted.
+ *
+ * @param max_mines The most mines that may be placed in the group.
+ * @param max_work The most steps to take, a step per assignment tried and per cell of each solution.
+ */
+void FrontierGroup::enumerate(uint64_t max_mines, uint64_t max_work)
+{
+    this->assignment.assign(this->cells.size(), 0);
+    this->tallies.assign(this->cells.size(), 0);
+    this->solutions_by_mines.assign(max_mines + 1, 0);
+    this->tallies_by_mines.assign((max_mines + 1) * this->cells.size(), 0);
+    this->mines = 0;
+    this->max_mines = max_mines;
+    this->solutions = 0;
+    this->assignments_tried = 0;
+    this->work_left = max_work;
+    this->exhausted = false;
+
+    this->search(0);
+    this->enumerated = true;
+}
+
+/**
+ * Whether enumerate has been run with the given mine limit since the group was built.
+ *
+ * @param max_mines
+ *
+ * @return enumerated
+ */
+bool FrontierGroup::is_enumerated(uint64_t max_mines)
+{
+    return this->enumerated && this->max_mines == max_mines;
+}
+
+/**
+ * Whether enumerate ran out of work before counting every solution, so the counts are incomplete.
+ *
+ * @return exhausted
+ */
+bool FrontierGroup::is_exhausted()
+{
+    return this->exhausted;
+}
+
+/**
+ * Get a hash of the group's cells and constraints, for finding groups that may be the same.
+ *
+ * @return signature
+ */
+uint64_t FrontierGroup::get_signature()
+{
+    return this->signature;
+}
+
+/**
+ * Check whether another group has exactly the same cells and constraints,
+ * in which case enumerating either gives the same counts.
+ *
+ * @param other
+ *
+ * @return Whether the constraints are the same.
+ */
+bool FrontierGroup::has_same_constraints(FrontierGroup& other)
+{
+    if (this->signature != other.signature
+    || this->cells != other.cells
+    || this->cell_constraint_offsets != other.cell_constraint_offsets
+    || this->cell_constraints != other.cell_constraints
+    || this->constraints.size() != other.constraints.size()
+    ) {
+        return false;
+    }
+
+    for (size_t k = 0; k < this->constraints.size(); k++) {
+        if (this->constraints[k].needed != other.constraints[k].needed
+        || this->constraints[k].unassigned != other.constraints[k].unassigned
+        ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Take the counts from a group with the same constraints, as if enumerate had been run.
+ *
+ * @param other A group for which has_same_constraints is true.
+ */
+void FrontierGroup::copy_counts(const FrontierGroup& other)
+{
+    this->max_mines = other.max_mines;
+    this->solutions = other.solutions;
+    this->enumerated = other.enumerated;
+    this->exhausted = other.exhausted;
+    this->assignments_tried = 0;
+    this->tallies.assign(other.tallies.begin(), other.tallies.end());
+    this->solutions_by_mines.assign(other.solutions_by_mines.begin(), other.solutions_by_mines.end());
+    this->tallies_by_mines.assign(other.tallies_by_mines.begin(), other.tallies_by_mines.end());
+}
+
+/**
+ * Get the number of cells in the group.
+ *
+ * @return size
+ */
+size_t FrontierGroup::size()
+{
+    return this->cells.size();
+}
+
+/**
+ * Get the map index of a cell.
+ *
+ * @param cell The cell's position in the group.
+ *
+ * @return A tile index
+ */
+uint64_t FrontierGroup::get_cell(size_t cell)
+{
+    return this->cells[cell];
+}
+
+/**
+ * Get the most mines enumerate was allowed to place.
+ *
+ * @return max mines
+ */
+uint64_t FrontierGroup::get_max_mines()
+{
+    return this->max_mines;
+}
+
+/**
+ * Get the number of satisfying assignments found by enumerate.
+ *
+ * @return solutions
+ */
+uint64_t FrontierGroup::get_solutions()
+{
+    return this->solutions;
+}
+
+/**
+ * Get the number of satisfying assignments placing exactly the given number of mines.
+ *
+ * @param mines 0 to get_max_mines()
+ *
+ * @return solutions
+ */
+uint64_t FrontierGroup::get_solutions(uint64_t mines)
+{
+    return this->solutions_by_mines[mines];
+}
+
+/**
+ * Get the number of satisfying assignments with a mine in the given cell.
+ *
+ * @param cell The cell's position in the group.
+ *
+ * @return tally
+ */
+uint64_t FrontierGroup::get_tally(size_t cell)
+{
+    return this->tallies[cell];
+}
+
+/**
+ * Get the number of satisfying assignments placing exactly the given number of mines,
+ * with a mine in the given cell.
+ *
+ * @param cell The cell's position in the group.
+ * @param mines 0 to get_max_mines()
+ *
+ * @return tally
+ */
+uint64_t FrontierGroup::get_tally(size_t cell, uint64_t mines)
+{
+    return this->tallies_by_mines[mines * this->cells.size() + cell];
+}
+
+/**
+ * Get the number of partial assignments enumerate tried.
+ * Always 0 unless solver statistics are enabled.
+ *
+ * @return assignments tried
+ */
+uint64_t FrontierGroup::get_assignments_tried()
+{
+    return this->assignments_tried;
+}
+
+/**
+ * Assign the cell at the given depth both ways and recurse,
+ * abandoning a branch as soon as a constraint can't be satisfied,
+ * and the whole search once it's out of work.
+ *
+ * @param depth The position in the assignment order to assign next.
+ */
+void FrontierGroup::search(size_t depth)
+{
+    if (this->work_left == 0) {
+        this->exhausted = true;
+        return;
+    }
+    this->work_left--;
+
+    if (depth == this->cells.size()) {
+        this->work_left -= std::min<uint64_t>(this->work_left, this->cells.size());
+        this->solutions++;
+        this->solutions_by_mines[this->mines]++;
+
+        uint64_t* tallies_by_mines = &this->tallies_by_mines[this->mines * this->cells.size()];
+        for (size_t i = 0; i < this->cells.size(); i++) {
+            this->tallies[i] += this->assignment[i];
+            tallies_by_mines[i] += this->assignment[i];
+        }
+        return;
+    }
+
+    //Safe
+    CASSPIR_STAT(this->assignments_tried++);
+    if (this->assign(depth, false)) {
+        this->search(depth + 1);
+    }
+    this->unassign(depth, false);
+
+    //Mine
+    if (this->mines < this->max_mines) {
+        this->assignment[depth] = 1;
+        this->mines++;
+        CASSPIR_STAT(this->assignments_tried++);
+        if (this->assign(depth, true)) {
+            this->search(depth + 1);
+        }
+        this->unassign(depth, true);
+        this->mines--;
+        this->assignment[depth] = 0;
+    }
+}
+
+/**
+ * Update the constraints touching a cell for it's assignment.
+ *
+ * @param depth The cell's position in the group.
+ * @param mine Whether the cell is assigned a mine.
+ *
+ * @return false if any of the constraints can no longer be satisfied.
+ */
+bool FrontierGroup::assign(size_t depth, bool mine)
+{
+    bool satisfiable = true;
+    for (uint32_t i = this->cell_constraint_offsets[depth]; i < this->cell_constraint_offsets[depth+1]; i++) {
+        Constraint& constraint = this->constraints[this->cell_constraints[i]];
+        constraint.unassigned--;
+        constraint.needed -= mine;
+        satisfiable &= constraint.needed >= 0 && constraint.needed <= constraint.unassigned;
+    }
+    return satisfiable;
+}
+
+/**
+ * Undo assign.
+ *
+ * @param depth The cell's position in the group.
+ * @param mine Whether the cell was assigned a mine.
+ */
+void FrontierGroup::unassign(size_t depth, bool mine)
+{
+    for (uint32_t i = this->cell_constraint_offsets[depth]; i < this->cell_constraint_offsets[depth+1]; i++) {
+        Constraint& constraint = this->constraints[this->cell_constraints[i]];
+        constraint.unassigned++;
+        constraint.needed += mine;
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Map.hh"
+#include "SolverStats.hh"
+#include "definitions.hh"
+
+namespace Casspir
+{
+    /**
+     * A group of unflipped tiles and the flipped numbers constraining them,
+     * copied out of the map so it can be evaluated without touching the map.
+     */
+    class FrontierGroup
+    {
+        public:
+            /**
+             * Working space for build, kept between groups so building doesn't allocate once it's grown.
+             */
+            struct Scratch {
+                std::vector<uint64_t> sorted;
+                std::vector<uint32_t> number_offsets, number_cells;
+                std::vector<uint32_t> touching_offsets, touching;
+                std::vector<uint32_t> order;
+                std::vector<uint8_t> seen;
+            };
+
+            FrontierGroup();
+            FrontierGroup(Map& map, const std::vector<uint64_t>& cells, const std::vector<uint64_t>& numbers);
+
+            template <typename M>
+            void build(
+                M& map,
+                const uint64_t* cells,
+                size_t num_cells,
+                const uint64_t* numbers,
+                size_t num_numbers,
+                Scratch& scratch
+            );
+
+            void enumerate(uint64_t max_mines, uint64_t max_work = UINT64_MAX);
+            bool is_enumerated(uint64_t max_mines);
+            bool is_exhausted();
+
+            uint64_t get_signature();
+            bool has_same_constraints(FrontierGroup& other);
+            void copy_counts(const FrontierGroup& other);
+
+            size_t size();
+            uint64_t get_cell(size_t cell);
+            uint64_t get_max_mines();
+            uint64_t get_solutions();
+            uint64_t get_solutions(uint64_t mines);
+            uint64_t get_tally(size_t cell);
+            uint64_t get_tally(size_t cell, uint64_t mines);
+            uint64_t get_assignments_tried();
+
+        private:
+            struct Constraint {
+                //Mines still to be placed amongst the unassigned cells.
+                int16_t needed;
+                uint16_t unassigned;
+            };
+
+            //Map indices of the cells, in assignment order.
+            std::vector<uint64_t> cells;
+            std::vector<Constraint> constraints;
+
+            //The constraints touching each cell, cell_constraints[offsets[i]..offsets[i+1]).
+            std::vector<uint32_t> cell_constraint_offsets;
+            std::vector<uint32_t> cell_constraints;
+
+            //Hash of the cells and constraints, groups with different signatures never match.
+            uint64_t signature;
+
+            //Search state
+            std::vector<uint8_t> assignment;
+            uint64_t mines, max_mines, solutions;
+            bool enumerated;
+
+            //Work the search may still do, a step per assignment tried and a step per cell of each solution.
+            //Running out leaves the counts incomplete, and the group exhausted.
+            uint64_t work_left;
+            bool exhausted;
+
+            //Only counted when solver statistics are enabled.
+            uint64_t assignments_tried;
+            std::vector<uint64_t> tallies;
+
+            //The same counts split by the number of mines placed, tallies are mines*size()+cell.
+            std::vector<uint64_t> solutions_by_mines;
+            std::vector<uint64_t> tallies_by_mines;
+
+            void search(size_t depth);
+            bool assign(size_t depth, bool mine);
+            void unassign(size_t depth, bool mine);
+    };
+}
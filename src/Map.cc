@@ -1,8 +1,11 @@
 #include <random>
 #include <iostream>
+#include <algorithm>
 #include <cassert>
 
 #include "Map.hh"
+#include "SeededMines.hh"
+#include "TileValues.hh"
 
 using namespace Casspir;
 
@@ -19,58 +22,132 @@ Map::Map(uint32_t width, uint32_t height, uint8_t difficulty, Point first_flip)
  {
     std::random_device r_device;
     std::default_random_engine r_engine(r_device());
+    this->generate(difficulty, first_flip, r_engine);
+}
+
+/**
+ * Initialise a width*height minesweeper map with mines placed using the given engine.
+ *
+ * @param width Width
+ * @param height Height
+ * @param difficulty Difficulty factor 0-255
+ * @param first_flip Coordinate of the players first move.
+ * @param r_engine Random engine to draw mine placements from.
+ */
+Map::Map(uint32_t width, uint32_t height, uint8_t difficulty, Point first_flip, std::default_random_engine& r_engine)
+ : Map(width, height)
+ {
+    this->generate(difficulty, first_flip, r_engine);
+}
+
+/**
+ * Initialise a width*height minesweeper map with mines in the given positions.
+ *
+ * @param width Width
+ * @param height Height
+ * @param mines A list of mine positions.
+ */
+Map::Map(uint32_t width, uint32_t height, std::set<Point> mines)
+: Map(width, height)
+{
+    for(auto& mine : mines) {
+        uint64_t index = mine.get_index(this->width);
+        assert (index < this->size);
+        this->mines.set(index);
+    }
+    this->compute_values();
+
+    this->total_mines = mines.size();
+    this->mines_remaining = this->total_mines;
+}
+
+/**
+ * Initialise a width*height minesweeper map from a mine bitmap.
+ *
+ * @param width Width
+ * @param height Height
+ * @param mines One bit per tile in index order, packed into (width*height+63)/64 words.
+ */
+Map::Map(uint32_t width, uint32_t height, const uint64_t* mines)
+: Map(width, height)
+{
+    this->mines.assign(mines);
+    this->compute_values();
+
+    this->total_mines = this->mines.count();
+    this->mines_remaining = this->total_mines;
+}
+
+/**
+ * Replace the map with a new random layout and make the first flip.
+ * The map's storage is reused, so this is cheaper than constructing a new map.
+ *
+ * @param difficulty Difficulty factor 0-255
+ * @param first_flip Coordinate of the players first move.
+ * @param r_engine Random engine to draw mine placements from.
+ */
+void Map::generate(uint8_t difficulty, Point first_flip, std::default_random_engine& r_engine)
+{
     std::uniform_real_distribution<> r_distribution(0, 1);
 
+    this->mines.clear();
+
     //Get first_flip neighbourhood so as not to place mines in there.
-    std::set<Point> first_flip_neighbourhood = this->get_neighbours(first_flip);
-    first_flip_neighbourhood.insert(first_flip);
+    uint64_t first_flip_index = first_flip.get_index(this->width);
+    Neighbours first_flip_neighbourhood = this->get_neighbours(first_flip_index);
 
     //Place mines randomly
     this->total_mines = 0;
     float mine_probability = ((float)(difficulty+20)) / 512.f;
-    for (size_t i = 0; i < this->state.size(); i++) {
-        Point position = Point::from_index(i, this->width);
-
+    for (uint64_t i = 0; i < this->size; i++) {
         //Place if random value breaks difficulty threshold
         //But not if this is the first flipped tile
-        if (r_distribution(r_engine) < mine_probability && first_flip_neighbourhood.count(position) == 0) {
-            this->state[i].mine = true;
+        if (r_distribution(r_engine) < mine_probability
+        && i != first_flip_index
+        && std::find(first_flip_neighbourhood.begin(), first_flip_neighbourhood.end(), i) == first_flip_neighbourhood.end()
+        ) {
+            this->mines.set(i);
             this->total_mines += 1;
-
-            //Increment neighbour values
-            for (const auto& neighbour : this->get_neighbours(position)) {
-                this->get_tile(neighbour).value ++;
-            }
         }
     }
+    this->compute_values();
 
-    this->mines_remaining = this->total_mines;
+    this->reset();
 
     //Flip the first tile
-    this->flip_recurse(first_flip);
+    this->flood_fill(first_flip_index);
+    this->check_completed();
 }
 
 /**
- * Initialise a width*height minesweeper map with mines in the given positions.
+ * Replace the map with exactly num_mines mines placed from the given seed, and make the first flip.
+ * The same seed and board always give the same layout.
+ * Mines are sampled without replacement from the tiles outside the first flip's neighbourhood.
  *
- * @param width Width
- * @param height Height
- * @param mines A list of mine positions.
+ * @param num_mines Mines to place, limited to the tiles available.
+ * @param first_flip Coordinate of the players first move.
+ * @param seed Seed for the mine placements.
  */
-Map::Map(uint32_t width, uint32_t height, std::set<Point> mines)
-: Map(width, height)
+void Map::generate_seeded(uint64_t num_mines, Point first_flip, uint64_t seed)
 {
-    for(auto& mine : mines) {
-        this->get_tile(mine).mine = true;
+    this->mines.clear();
 
-        //Increment neighbour values
-        for (const auto& neighbour : this->get_neighbours(mine)) {
-            this->get_tile(neighbour).value ++;
-        }
-    }
+    uint64_t first_flip_index = first_flip.get_index(this->width);
+    this->total_mines = SeededMines::place(
+        this->mines,
+        this->size,
+        first_flip_index,
+        this->get_neighbours(first_flip_index),
+        num_mines,
+        seed
+    );
+    this->compute_values();
 
-    this->total_mines = mines.size();
-    this->mines_remaining = this->total_mines;
+    this->reset();
+
+    //Flip the first tile
+    this->flood_fill(first_flip_index);
+    this->check_completed();
 }
 
 /**
@@ -82,11 +159,25 @@ Map::Map(uint32_t width, uint32_t height, std::set<Point> mines)
 Map::Map(uint32_t width, uint32_t height)
     : width(width), height(height)
 {
-    this->state.resize(width*height);
+    this->size = static_cast<uint64_t>(width) * height;
+    this->mines.resize(this->size);
+    this->flagged.resize(this->size);
+    this->flipped.resize(this->size);
+    this->values.assign((this->size + 1) / 2, 0);
+    this->frontier.resize(this->size);
+    this->frontier_size = 0;
     this->status = MapStatus::IN_PROGRESS;
     this->tiles_flipped = 0;
 }
 
+/**
+ * Recompute every tile's value from the mines, once they're all placed.
+ */
+void Map::compute_values()
+{
+    TileValues::compute(this->mines, this->width, this->height, this->values);
+}
+
 /**
  * If the tile is unflipped, flip it and adjoining tiles recusively while tile value is non zero.
  * If the tile is flipped, expand adjoining unflipped tiles.
@@ -97,21 +188,21 @@ Map::Map(uint32_t width, uint32_t height)
  */
 uint64_t Map::flip(Point position)
 {
-    TileState& tile = this->get_tile(position);
-    std::set<Point> neighbours = this->get_neighbours(position);
+    uint64_t index = position.get_index(this->width);
+    assert (index < this->size);
     uint64_t flipped = 0;
 
-    if (tile.flipped) {
+    if (this->is_flipped(index)) {
         //Already flipped,
         //check if it's number is satisfied by flags and flip the neighbours.
-        if (this->is_tile_satisfied(position)) {
-            for (const auto& neighbour : neighbours) {
-                flipped += this->flip_recurse(neighbour);
+        if (this->is_tile_satisfied(index)) {
+            for (uint64_t neighbour : this->get_neighbours(index)) {
+                flipped += this->flood_fill(neighbour);
             }
         }
-    } else if (!tile.flagged) {
+    } else if (!this->is_flagged(index)) {
         //Not yet flipped or flagged, let the flippening begin.
-        flipped = this->flip_recurse(position);
+        flipped = this->flood_fill(index);
     }
 
     this->check_completed();
@@ -131,18 +222,22 @@ void Map::flag(Point position)
         return;
     }
 
-    TileState& tile = this->get_tile(position);
-    if (!tile.flipped) {
-        if (tile.flagged) {
-            tile.flagged = false;
+    uint64_t index = position.get_index(this->width);
+    assert (index < this->size);
+    if (!this->is_flipped(index)) {
+        if (this->is_flagged(index)) {
+            this->flagged.unset(index);
+            this->record(index, JOURNAL_FLAGGED);
             this->mines_remaining += 1;
         } else {
             //Only allow if there are any mines remaining
             if (this->mines_remaining > 0) {
-                tile.flagged = true;
+                this->flagged.set(index);
+                this->record(index, JOURNAL_FLAGGED);
                 this->mines_remaining -= 1;
             }
         }
+        this->touch(index);
     }
 
     this->check_completed();
@@ -158,7 +253,7 @@ void Map::check_completed()
     }
 
     if (this->get_mines_remaining() == 0
-    && (this->get_num_flipped() + this->get_total_mines()) == this->state.size()
+    && (this->get_num_flipped() + this->get_total_mines()) == this->size
     ) {
         this->status = MapStatus::COMPLETE;
     }
@@ -171,61 +266,263 @@ void Map::check_completed()
  */
 void Map::reset()
 {
-    for (auto& tile : this->state) {
-        tile.flipped = false;
-        tile.flagged = false;
-    }
+    this->flipped.clear();
+    this->flagged.clear();
+    this->frontier.clear();
+    this->frontier_size = 0;
+    this->dirty_tiles.clear();
     this->mines_remaining = this->total_mines;
     this->tiles_flipped = 0;
     this->status = MapStatus::IN_PROGRESS;
+    this->checkpoints.clear();
+    this->journal.clear();
+}
+
+/**
+ * Remember the current state so it can be returned to with rollback.
+ * Changes are journaled while any checkpoint is held, so rolling back takes time
+ * proportional to what changed since, rather than the size of the map.
+ * Checkpoints nest, reset drops them all.
+ *
+ * @return A token for rollback or release.
+ */
+uint64_t Map::checkpoint()
+{
+    Checkpoint checkpoint;
+    checkpoint.journal_size = this->journal.size();
+    checkpoint.tiles_flipped = this->tiles_flipped;
+    checkpoint.mines_remaining = this->mines_remaining;
+    checkpoint.frontier_size = this->frontier_size;
+    checkpoint.status = this->status;
+    this->checkpoints.push_back(checkpoint);
+
+    return this->checkpoints.size() - 1;
+}
+
+/**
+ * Undo every flip and flag made since the checkpoint was taken.
+ * The checkpoint, and any taken after it, are dropped.
+ * Frontier tiles around the undone changes are marked dirty, as the solver may have seen them changed.
+ *
+ * @param token From checkpoint.
+ */
+void Map::rollback(uint64_t token)
+{
+    assert (token < this->checkpoints.size());
+    const Checkpoint& checkpoint = this->checkpoints[token];
+
+    while (this->journal.size() > checkpoint.journal_size) {
+        uint64_t change = this->journal.back();
+        this->journal.pop_back();
+
+        uint64_t index = change >> 2;
+        switch (change & 3) {
+            case JOURNAL_FLIPPED:
+                this->flipped.toggle(index);
+                break;
+            case JOURNAL_FLAGGED:
+                this->flagged.toggle(index);
+                break;
+            default:
+                this->frontier.toggle(index);
+                break;
+        }
+
+        if (this->is_frontier(index)) {
+            this->dirty_tiles.push_back(index);
+        }
+        for (uint64_t neighbour : this->get_neighbours(index)) {
+            if (this->is_frontier(neighbour)) {
+                this->dirty_tiles.push_back(neighbour);
+            }
+        }
+    }
+
+    this->tiles_flipped = checkpoint.tiles_flipped;
+    this->mines_remaining = checkpoint.mines_remaining;
+    this->frontier_size = checkpoint.frontier_size;
+    this->status = checkpoint.status;
+    this->checkpoints.resize(token);
+}
+
+/**
+ * Keep the changes made since the checkpoint was taken and drop it, and any taken after it.
+ * Once no checkpoints are held changes stop being journaled.
+ *
+ * @param token From checkpoint.
+ */
+void Map::release(uint64_t token)
+{
+    assert (token < this->checkpoints.size());
+    this->checkpoints.resize(token);
+    if (this->checkpoints.empty()) {
+        this->journal.clear();
+    }
+}
+
+/**
+ * Whether any checkpoint is held.
+ *
+ * @return has checkpoint
+ */
+bool Map::has_checkpoint()
+{
+    return !this->checkpoints.empty();
 }
 
 /**
- * Recurively flip this tile and it's neighbours.
- * Continue recursion if tile value is zero.
+ * Flip this tile, and if it's value is zero, flood outwards
+ * flipping neighbours until non-zero tiles are reached.
+ * Uses an explicit work stack so large openings can't overflow the call stack.
  *
- * @param position The position to flip and recurse from
+ * @param index The tile index to flip and flood from
  *
  * @return The number of tiles flipped.
  */
-uint64_t Map::flip_recurse(Point position)
+uint64_t Map::flood_fill(uint64_t index)
 {
     if (this->get_status() != MapStatus::IN_PROGRESS) {
         return 0;
     }
 
-    TileState& tile = this->get_tile(position);
+    assert (index < this->size);
 
     //If the tile is already flipped or flagged, ignore it.
-    if (tile.flipped || tile.flagged) {
+    if (this->is_flipped(index) || this->is_flagged(index)) {
         return 0;
     }
 
     //Flip the tile.
-    tile.flipped = true;
+    this->flipped.set(index);
+    this->record(index, JOURNAL_FLIPPED);
     this->tiles_flipped++;
 
     //If the tile is a mine, fail the game
-    if (tile.mine) {
+    if (this->is_mine(index)) {
         this->status = MapStatus::FAILED;
+        this->touch(index);
         return 1;
     }
 
     //If the tile value is non-zero we're done.
-    if (tile.value != 0) {
+    if (this->get_value(index) != 0) {
+        this->touch(index);
         return 1;
     }
 
-    //Recurse into the neighbours.
-    std::set<Point> neighbours = this->get_neighbours(position);
-
+    //Flood through zero valued tiles.
+    //Neighbours of a zero tile are never mines, so the game can't fail from here.
     uint64_t flipped = 1;
-    for (const auto neighbour : neighbours) {
-        flipped += this->flip_recurse(neighbour);
+    this->flood_stack.push_back(index);
+    while (!this->flood_stack.empty()) {
+        uint64_t current = this->flood_stack.back();
+        this->flood_stack.pop_back();
+
+        for (uint64_t neighbour : this->get_neighbours(current)) {
+            if (this->is_flipped(neighbour)) {
+                //A revealed number may have just lost it's last open neighbour.
+                if (this->is_frontier(neighbour)) {
+                    this->refresh_frontier(neighbour);
+                }
+                continue;
+            }
+
+            if (this->is_flagged(neighbour)) {
+                continue;
+            }
+
+            this->flipped.set(neighbour);
+            this->record(neighbour, JOURNAL_FLIPPED);
+            flipped++;
+
+            if (this->get_value(neighbour) == 0) {
+                this->flood_stack.push_back(neighbour);
+            } else {
+                this->touch(neighbour);
+            }
+        }
     }
+    this->tiles_flipped += flipped - 1;
+
     return flipped;
 }
 
+/**
+ * Recompute whether a tile is on the frontier.
+ * Frontier tiles are marked dirty so the solver reconsiders them.
+ *
+ * @param index
+ */
+void Map::refresh_frontier(uint64_t index)
+{
+    bool is_frontier = false;
+    if (this->is_flipped(index) && !this->is_mine(index) && this->get_value(index) > 0) {
+        for (uint64_t neighbour : this->get_neighbours(index)) {
+            if (!this->is_flipped(neighbour) && !this->is_flagged(neighbour)) {
+                is_frontier = true;
+                break;
+            }
+        }
+    }
+
+    if (is_frontier != this->is_frontier(index)) {
+        this->frontier.set(index, is_frontier);
+        this->record(index, JOURNAL_FRONTIER);
+        if (is_frontier) {
+            this->frontier_size++;
+        } else {
+            this->frontier_size--;
+        }
+    }
+
+    if (is_frontier) {
+        this->dirty_tiles.push_back(index);
+    }
+}
+
+/**
+ * Refresh the frontier around a tile that was just flipped or flagged.
+ *
+ * @param index
+ */
+void Map::touch(uint64_t index)
+{
+    this->refresh_frontier(index);
+    for (uint64_t neighbour : this->get_neighbours(index)) {
+        if (this->is_flipped(neighbour)) {
+            this->refresh_frontier(neighbour);
+        }
+    }
+}
+
+/**
+ * Move the dirty frontier tiles into the given list, in ascending order.
+ * The map's own list is left empty.
+ * They're copied rather than swapped so each list keeps it's own storage.
+ *
+ * @param tiles A list to fill, any existing contents are discarded.
+ */
+void Map::take_dirty_tiles(std::vector<uint64_t>& tiles)
+{
+    tiles.assign(this->dirty_tiles.begin(), this->dirty_tiles.end());
+    this->dirty_tiles.clear();
+    std::sort(tiles.begin(), tiles.end());
+    tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+}
+
+/**
+ * Mark the whole frontier dirty, for consumers that haven't seen it yet.
+ */
+void Map::mark_frontier_dirty()
+{
+    this->dirty_tiles.clear();
+    for (uint64_t w = 0; w < this->frontier.num_words(); w++) {
+        for (uint64_t bits = this->frontier.word(w); bits != 0; bits &= bits - 1) {
+            this->dirty_tiles.push_back(w * 64 + __builtin_ctzll(bits));
+        }
+    }
+}
+
 /**
  * Get the map width.
  *
@@ -247,13 +544,28 @@ uint32_t Map::get_height()
 }
 
 /**
- * Get the map state.
+ * Get the number of tiles on the map.
+ *
+ * @return width*height
+ */
+uint64_t Map::get_size()
+{
+    return this->size;
+}
+
+/**
+ * Get a snapshot of the map state, one entry per tile.
  *
  * @return state
  */
-std::vector<TileState>& Map::get_state()
+std::vector<TileState> Map::get_state()
 {
-    return this->state;
+    std::vector<TileState> state;
+    state.reserve(this->size);
+    for (uint64_t i = 0; i < this->size; i++) {
+        state.push_back(this->get_tile(i));
+    }
+    return state;
 }
 
 /**
@@ -296,12 +608,76 @@ MapStatus Map::get_status()
     return this->status;
 }
 
+/**
+ * Get the number of bytes used to store the tile state.
+ *
+ * @return bytes
+ */
+uint64_t Map::get_memory_usage()
+{
+    return this->mines.memory_usage()
+        + this->flagged.memory_usage()
+        + this->flipped.memory_usage()
+        + this->frontier.memory_usage()
+        + this->values.size();
+}
+
+/**
+ * Get the mine bitplane.
+ *
+ * @return One bit per tile, set if the tile is a mine.
+ */
+const Bitplane& Map::get_mines()
+{
+    return this->mines;
+}
+
+/**
+ * Get the flag bitplane.
+ *
+ * @return One bit per tile, set if the tile is flagged.
+ */
+const Bitplane& Map::get_flagged()
+{
+    return this->flagged;
+}
+
+/**
+ * Get the flip bitplane.
+ *
+ * @return One bit per tile, set if the tile is flipped.
+ */
+const Bitplane& Map::get_flipped()
+{
+    return this->flipped;
+}
+
+/**
+ * Get the frontier bitplane.
+ *
+ * @return One bit per tile, set if the tile is a flipped number with open neighbours.
+ */
+const Bitplane& Map::get_frontier()
+{
+    return this->frontier;
+}
+
+/**
+ * Get the number of tiles on the frontier.
+ *
+ * @return frontier size
+ */
+uint64_t Map::get_frontier_size()
+{
+    return this->frontier_size;
+}
+
 /**
  * Get the tile in the given position.
  *
  * @return A tile
  */
-TileState& Map::get_tile(Point position)
+TileState Map::get_tile(Point position)
 {
     uint64_t index = position.get_index(this->width);
     return this->get_tile(index);
@@ -312,21 +688,43 @@ TileState& Map::get_tile(Point position)
  *
  * @return A tile
  */
-TileState& Map::get_tile(uint64_t index)
+TileState Map::get_tile(uint64_t index)
 {
-    assert (index < this->state.size());
-    return this->state.at(index);
+    assert (index < this->size);
+    return TileState(
+        this->get_value(index),
+        this->is_mine(index),
+        this->is_flagged(index),
+        this->is_flipped(index)
+    );
 }
 
+/**
+ * Check whether the tile's value is matched by the number of flagged neighbours.
+ *
+ * @param position
+ *
+ * @return true if satisfied.
+ */
 bool Map::is_tile_satisfied(Point position)
 {
-    TileState& tile = this->get_tile(position);
-    std::set<Point> neighbours = this->get_neighbours(position);
+    return this->is_tile_satisfied(position.get_index(this->width));
+}
+
+/**
+ * Check whether the tile's value is matched by the number of flagged neighbours.
+ *
+ * @param index
+ *
+ * @return true if satisfied.
+ */
+bool Map::is_tile_satisfied(uint64_t index)
+{
     uint8_t flags = 0;
-    for (const auto& neighbour : neighbours) {
-        flags += this->get_tile(neighbour).flagged;
+    for (uint64_t neighbour : this->get_neighbours(index)) {
+        flags += this->is_flagged(neighbour);
     }
-    return (flags == tile.value);
+    return (flags == this->get_value(index));
 }
 
 /**
@@ -334,12 +732,12 @@ bool Map::is_tile_satisfied(Point position)
  */
 void Map::print(bool revealed)
 {
-    for (size_t i = 0; i < this->state.size(); i++) {
+    for (uint64_t i = 0; i < this->size; i++) {
         if ((i % this->width) == 0) {
             std::cout << std::endl;
         }
         char token;
-        TileState tile = this->state[i];
+        TileState tile = this->get_tile(i);
         if (tile.flipped || revealed) {
             if (tile.mine) {
                 token = '*';
@@ -358,6 +756,7 @@ void Map::print(bool revealed)
 
 /**
  * Find the neighbour positions of a tile.
+ * Kept for compatibility, internally the allocation free index variant is used.
  *
  * @param position The position to find neighbours for.
  */
@@ -365,43 +764,9 @@ std::set<Point> Map::get_neighbours(Point position)
 {
     std::set<Point> neighbours;
 
-    bool \
-        U = position.y > 0,
-        D = position.y < (this->height - 1),
-        L = position.x > 0,
-        R = position.x < (this->width - 1);
-
-    if (U) {
-        neighbours.insert(Point(position.x, position.y-1));
-    }
-
-    if (D) {
-        neighbours.insert(Point(position.x, position.y+1));
-    }
-
-    if (L) {
-        neighbours.insert(Point(position.x-1, position.y));
-    }
-
-    if (R) {
-        neighbours.insert(Point(position.x+1, position.y));
-    }
-
-    if (U && L) {
-        neighbours.insert(Point(position.x-1, position.y-1));
-    }
-
-    if (U && R) {
-        neighbours.insert(Point(position.x+1, position.y-1));
-    }
-
-    if (D && L) {
-        neighbours.insert(Point(position.x-1, position.y+1));
-    }
-
-    if (D && R) {
-        neighbours.insert(Point(position.x+1, position.y+1));
+    for (uint64_t neighbour : this->get_neighbours(position.get_index(this->width))) {
+        neighbours.insert(Point::from_index(neighbour, this->width));
     }
 
     return neighbours;
-}
\ No newline at end of file
+}
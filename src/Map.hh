@@ -3,8 +3,10 @@
 #include <cstdint>
 #include <vector>
 #include <set>
+#include <random>
 
 #include "definitions.hh"
+#include "Bitplane.hh"
 
 namespace Casspir
 {
@@ -12,27 +14,126 @@ namespace Casspir
     {
         public:
             Map(uint32_t width, uint32_t height, uint8_t difficulty, Point first_flip);
+            Map(uint32_t width, uint32_t height, uint8_t difficulty, Point first_flip, std::default_random_engine& r_engine);
             Map(uint32_t width, uint32_t height, std::set<Casspir::Point> mines);
+            Map(uint32_t width, uint32_t height, const uint64_t* mines);
+
+            void generate(uint8_t difficulty, Point first_flip, std::default_random_engine& r_engine);
+            void generate_seeded(uint64_t num_mines, Point first_flip, uint64_t seed);
 
             uint64_t flip(Point position);
             void flag(Point position);
             void reset();
 
+            uint64_t checkpoint();
+            void rollback(uint64_t token);
+            void release(uint64_t token);
+            bool has_checkpoint();
+
             uint32_t get_width();
             uint32_t get_height();
-            std::vector<TileState>& get_state();
+            uint64_t get_size();
+            std::vector<TileState> get_state();
             uint64_t get_num_flipped();
             uint64_t get_mines_remaining();
             uint64_t get_total_mines();
             MapStatus get_status();
+            uint64_t get_memory_usage();
+
+            TileState get_tile(Point position);
+            TileState get_tile(uint64_t index);
+
+            //Single field accessors, inlined as they sit in the solver's inner loops.
+            bool is_mine(uint64_t index)
+            {
+                return this->mines.get(index);
+            }
+
+            bool is_flagged(uint64_t index)
+            {
+                return this->flagged.get(index);
+            }
+
+            bool is_flipped(uint64_t index)
+            {
+                return this->flipped.get(index);
+            }
 
-            TileState& get_tile(Point position);
-            TileState& get_tile(uint64_t index);
+            uint8_t get_value(uint64_t index)
+            {
+                return (this->values[index >> 1] >> ((index & 1) << 2)) & 0xF;
+            }
+
+            bool is_frontier(uint64_t index)
+            {
+                return this->frontier.get(index);
+            }
+
+            const Bitplane& get_mines();
+            const Bitplane& get_flagged();
+            const Bitplane& get_flipped();
+            const Bitplane& get_frontier();
+            uint64_t get_frontier_size();
+
+            void take_dirty_tiles(std::vector<uint64_t>& tiles);
+            void mark_frontier_dirty();
 
             bool is_tile_satisfied(Point position);
+            bool is_tile_satisfied(uint64_t index);
 
             std::set<Point> get_neighbours(Point position);
 
+            /**
+             * Find the neighbour indices of a tile.
+             * Indices are given in ascending order.
+             * Inlined as it sits in the flood fill and solver loops.
+             *
+             * @param index The tile index to find neighbours for.
+             */
+            Neighbours get_neighbours(uint64_t index)
+            {
+                Neighbours neighbours;
+                uint32_t x = index % this->width;
+
+                bool \
+                    U = index >= this->width,
+                    D = index < (this->size - this->width),
+                    L = x > 0,
+                    R = x < (this->width - 1);
+
+                if (U) {
+                    uint64_t above = index - this->width;
+                    if (L) {
+                        neighbours.push(above - 1);
+                    }
+                    neighbours.push(above);
+                    if (R) {
+                        neighbours.push(above + 1);
+                    }
+                }
+
+                if (L) {
+                    neighbours.push(index - 1);
+                }
+
+                if (R) {
+                    neighbours.push(index + 1);
+                }
+
+                if (D) {
+                    uint64_t below = index + this->width;
+                    if (L) {
+                        neighbours.push(below - 1);
+                    }
+                    neighbours.push(below);
+                    if (R) {
+                        neighbours.push(below + 1);
+                    }
+                }
+
+                return neighbours;
+            }
+
             void print(bool revealed = false);
 
         private:
@@ -41,9 +142,49 @@ namespace Casspir
             uint32_t width, height;
             uint64_t total_mines, mines_remaining, tiles_flipped;
             MapStatus status;
-            std::vector<TileState> state;
+            uint64_t size;
+
+            //Tile state is stored as bitplanes plus a nibble per tile value.
+            Bitplane mines, flagged, flipped;
+            std::vector<uint8_t> values;
+
+            //Flipped numbered tiles with unflipped, unflagged neighbours.
+            Bitplane frontier;
+            uint64_t frontier_size;
+
+            //Frontier tiles whose neighbourhood changed since they were last taken.
+            std::vector<uint64_t> dirty_tiles;
+
+            std::vector<uint64_t> flood_stack;
+
+            //Changes to the planes since the oldest checkpoint, each (index << 2) | plane.
+            //Every change is a toggle, so they're undone by toggling back in reverse.
+            enum JournalPlane : uint64_t {
+                JOURNAL_FLIPPED,
+                JOURNAL_FLAGGED,
+                JOURNAL_FRONTIER
+            };
+            std::vector<uint64_t> journal;
+
+            struct Checkpoint {
+                size_t journal_size;
+                uint64_t tiles_flipped, mines_remaining, frontier_size;
+                MapStatus status;
+            };
+            std::vector<Checkpoint> checkpoints;
+
+            void record(uint64_t index, JournalPlane plane)
+            {
+                if (!this->checkpoints.empty()) {
+                    this->journal.push_back((index << 2) | plane);
+                }
+            }
+
+            void compute_values();
+            void refresh_frontier(uint64_t index);
+            void touch(uint64_t index);
 
-            uint64_t flip_recurse(Point position);
+            uint64_t flood_fill(uint64_t index);
             void check_completed();
     };
 }
@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <cmath>
+
+#include "MineProbabilities.hh"
+
+using namespace Casspir;
+
+/**
+ * Start with nothing computed.
+ */
+MineProbabilities::MineProbabilities()
+{
+    this->consistent = false;
+    this->interior_probability = 0;
+}
+
+/**
+ * Work out the chance of a mine in every cell of the given groups and in the interior.
+ * Every arrangement of the remaining mines consistent with the groups is counted equally.
+ * Arrangements too unlikely to be represented in a double are treated as impossible.
+ *
+ * @param groups Groups enumerated by FrontierGroup::enumerate, they must not share any cells.
+ * @param interior The number of unflipped, unflagged tiles outside the groups.
+ * @param mines_remaining The number of mines not yet flagged.
+ */
+void MineProbabilities::compute(std::vector<FrontierGroup>& groups, uint64_t interior, uint64_t mines_remaining)
+{
+    uint64_t max_mines = mines_remaining;
+    this->consistent = false;
+    this->interior_probability = 0;
+
+    //Per group storage only grows, so computing again doesn't allocate once it's grown.
+    if (this->probabilities.size() < groups.size()) {
+        this->probabilities.resize(groups.size());
+    }
+    if (this->prefixes.size() < groups.size() + 1) {
+        this->prefixes.resize(groups.size() + 1);
+        this->lowest.resize(groups.size() + 1);
+        this->counts.resize(groups.size() + 1);
+    }
+
+    //Combine the groups one at a time by the number of mines placed.
+    //Only the band of totals the groups so far can actually place is kept, however many mines remain,
+    //prefixes[g][i] being the ways the groups before g place lowest[g] + i mines.
+    this->prefixes[0].assign(1, 1.);
+    this->lowest[0] = 0;
+    for (size_t g = 0; g < groups.size(); g++) {
+        FrontierGroup& group = groups[g];
+        const std::vector<double>& prefix = this->prefixes[g];
+        std::vector<double>& combined = this->prefixes[g+1];
+        if (group.get_solutions() == 0) {
+            return;
+        }
+
+        //The group's own range of mine counts that have any solutions.
+        uint64_t low = 0;
+        while (group.get_solutions(low) == 0) {
+            low++;
+        }
+        uint64_t high = group.get_max_mines();
+        while (group.get_solutions(high) == 0) {
+            high--;
+        }
+        this->counts[g] = high - low + 1;
+
+        uint64_t base = this->lowest[g];
+        this->lowest[g+1] = base + low;
+        if (base + low > max_mines) {
+            return;
+        }
+
+        combined.assign(std::min<uint64_t>(max_mines, base + prefix.size() - 1 + high) - (base + low) + 1, 0);
+        for (uint64_t i = 0; i < prefix.size(); i++) {
+            for (uint64_t k = low; k <= high && i + k - low < combined.size(); k++) {
+                combined[i + k - low] += prefix[i] * group.get_solutions(k);
+            }
+        }
+        normalise(combined);
+    }
+
+    //The interior takes whatever the groups leave, weighted by C(interior, max_mines - m),
+    //relative to the largest so huge boards don't overflow.
+    //suffix[i] is the weight of the groups from g on, and the interior, given lowest[g] + i mines before them.
+    const std::vector<double>& total = this->prefixes[groups.size()];
+    uint64_t base = this->lowest[groups.size()];
+    this->suffix.assign(total.size(), 0);
+    double max_log = -INFINITY;
+    for (uint64_t i = 0; i < total.size(); i++) {
+        if (max_mines - (base + i) <= interior) {
+            max_log = std::max(max_log, log_choose(interior, max_mines - (base + i)));
+        }
+    }
+    for (uint64_t i = 0; i < total.size(); i++) {
+        if (max_mines - (base + i) <= interior) {
+            this->suffix[i] = std::exp(log_choose(interior, max_mines - (base + i)) - max_log);
+        }
+    }
+
+    //The interior is the same for every arrangement placing the same number of mines in the groups.
+    double weight = 0;
+    double interior_mines = 0;
+    bool interior_full = true;
+    for (uint64_t i = 0; i < total.size(); i++) {
+        double w = total[i] * this->suffix[i];
+        if (w == 0) {
+            continue;
+        }
+        weight += w;
+        interior_mines += w * (max_mines - (base + i));
+        interior_full &= max_mines - (base + i) == interior;
+    }
+
+    if (weight == 0) {
+        return;
+    }
+
+    if (interior > 0) {
+        this->interior_probability = interior_full ? 1. : interior_mines / (weight * interior);
+    }
+
+    //Work back through the groups, weighting each of a group's mine counts
+    //by the groups before it and the groups and interior after it.
+    std::vector<double>& count_weights = this->count_weights;
+    for (size_t g = groups.size(); g-- > 0;) {
+        FrontierGroup& group = groups[g];
+        const std::vector<double>& prefix = this->prefixes[g];
+        uint64_t low = this->lowest[g+1] - this->lowest[g];
+
+        //The suffix is relative to the fewest mines the groups up to this one place.
+        count_weights.assign(this->counts[g], 0);
+        for (uint64_t k = 0; k < count_weights.size(); k++) {
+            for (uint64_t i = 0; i < prefix.size() && i + k < this->suffix.size(); i++) {
+                count_weights[k] += prefix[i] * this->suffix[i+k];
+            }
+        }
+
+        double group_weight = 0;
+        for (uint64_t k = 0; k < count_weights.size(); k++) {
+            group_weight += group.get_solutions(low + k) * count_weights[k];
+        }
+
+        if (group_weight == 0) {
+            return;
+        }
+
+        //Summed in the same order as the group weight, so certain cells come out at exactly 0 or 1.
+        std::vector<double>& cell_probabilities = this->probabilities[g];
+        cell_probabilities.assign(group.size(), 0);
+        for (size_t c = 0; c < group.size(); c++) {
+            double mines = 0;
+            for (uint64_t k = 0; k < count_weights.size(); k++) {
+                mines += group.get_tally(c, low + k) * count_weights[k];
+            }
+            cell_probabilities[c] = mines / group_weight;
+        }
+
+        //Fold this group into the weight of everything after the groups before it.
+        this->next_suffix.assign(prefix.size(), 0);
+        for (uint64_t i = 0; i < prefix.size(); i++) {
+            for (uint64_t k = 0; k < count_weights.size() && i + k < this->suffix.size(); k++) {
+                this->next_suffix[i] += group.get_solutions(low + k) * this->suffix[i+k];
+            }
+        }
+        //Copied rather than swapped, the band shrinks from group to group
+        //and swapping would leave each buffer's capacity depending on how many groups there were.
+        normalise(this->next_suffix);
+        this->suffix.assign(this->next_suffix.begin(), this->next_suffix.end());
+    }
+
+    this->consistent = true;
+}
+
+/**
+ * Whether any arrangement of the mines fits the groups given to compute.
+ * The probabilities are meaningless otherwise.
+ *
+ * @return consistent
+ */
+bool MineProbabilities::is_consistent()
+{
+    return this->consistent;
+}
+
+/**
+ * Get the chance of a mine in a cell of a group.
+ *
+ * @param group The group's position in the list given to compute.
+ * @param cell The cell's position in the group.
+ *
+ * @return 0 to 1
+ */
+double MineProbabilities::get_probability(size_t group, size_t cell)
+{
+    return this->probabilities[group][cell];
+}
+
+/**
+ * Get the chance of a mine in any one interior tile.
+ *
+ * @return 0 to 1
+ */
+double MineProbabilities::get_interior_probability()
+{
+    return this->interior_probability;
+}
+
+/**
+ * Scale the counts so the largest is 1, only their ratios matter.
+ *
+ * @param counts
+ */
+void MineProbabilities::normalise(std::vector<double>& counts)
+{
+    double max = 0;
+    for (double count : counts) {
+        max = std::max(max, count);
+    }
+
+    if (max > 0) {
+        for (double& count : counts) {
+            count /= max;
+        }
+    }
+}
+
+/**
+ * The natural log of n choose k.
+ *
+ * @param n
+ * @param k 0 to n
+ *
+ * @return log(C(n, k))
+ */
+double MineProbabilities::log_choose(uint64_t n, uint64_t k)
+{
+    return std::lgamma(n + 1.) - std::lgamma(k + 1.) - std::lgamma(n - k + 1.);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "FrontierGroup.hh"
+#include "definitions.hh"
+
+namespace Casspir
+{
+    /**
+     * Chance of each unflipped tile being a mine, over the whole board.
+     * Combines the enumerated frontier groups by how many mines they place,
+     * weighting each total by the ways the rest can be spread over the unconstrained interior.
+     * It's exact for the groups given, but the solver counts the cells of groups too big to enumerate
+     * as interior, so on boards with such groups their constraints are ignored.
+     */
+    class MineProbabilities
+    {
+        public:
+            MineProbabilities();
+
+            void compute(std::vector<FrontierGroup>& groups, uint64_t interior, uint64_t mines_remaining);
+
+            bool is_consistent();
+            double get_probability(size_t group, size_t cell);
+            double get_interior_probability();
+
+        private:
+            bool consistent;
+            std::vector< std::vector<double> > probabilities;
+            double interior_probability;
+
+            //Ways to place each number of mines in the groups before each group,
+            //prefixes[g][i] for lowest[g] + i mines.
+            std::vector< std::vector<double> > prefixes;
+            std::vector<uint64_t> lowest;
+
+            //How many mine counts, from it's fewest, each group has solutions for.
+            std::vector<uint64_t> counts;
+
+            //Weight of the groups from g on, and the interior, given lowest[g] + i mines placed before them.
+            std::vector<double> suffix, next_suffix;
+
+            //Weight of each of a group's mine counts.
+            std::vector<double> count_weights;
+
+            static void normalise(std::vector<double>& counts);
+            static double log_choose(uint64_t n, uint64_t k);
+    };
+}
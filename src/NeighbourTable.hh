@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Casspir
+{
+    /**
+     * The neighbours of every tile of a width*height board, worked out at compile time.
+     * Each entry is the neighbour count followed by up to 8 neighbour indices in ascending order,
+     * so looking neighbours up needs no edge checks.
+     */
+    template <uint32_t W, uint32_t H>
+    class NeighbourTable
+    {
+        public:
+            static_assert(W * H <= UINT16_MAX, "neighbour indices are stored as 16 bits");
+
+            uint16_t entries[W * H][9];
+
+            constexpr NeighbourTable() : entries()
+            {
+                for (uint32_t y = 0; y < H; y++) {
+                    for (uint32_t x = 0; x < W; x++) {
+                        uint16_t* entry = this->entries[y * W + x];
+                        for (uint32_t ny = y == 0 ? 0 : y - 1; ny <= y + 1 && ny < H; ny++) {
+                            for (uint32_t nx = x == 0 ? 0 : x - 1; nx <= x + 1 && nx < W; nx++) {
+                                if (nx != x || ny != y) {
+                                    entry[++entry[0]] = ny * W + nx;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+    };
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Casspir
+{
+    /**
+     * A small, fast, seedable generator (xoshiro256**).
+     * The same seed always gives the same sequence, on any platform.
+     */
+    class Random
+    {
+        public:
+            Random(uint64_t seed = 0)
+            {
+                this->seed(seed);
+            }
+
+            /**
+             * Fill the state from a seed with splitmix64, so similar seeds give unrelated sequences.
+             */
+            void seed(uint64_t seed)
+            {
+                for (uint64_t& word : this->state) {
+                    seed += 0x9e3779b97f4a7c15ULL;
+                    uint64_t z = seed;
+                    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                    word = z ^ (z >> 31);
+                }
+            }
+
+            uint64_t next()
+            {
+                uint64_t result = rotl(this->state[1] * 5, 7) * 9;
+                uint64_t t = this->state[1] << 17;
+
+                this->state[2] ^= this->state[0];
+                this->state[3] ^= this->state[1];
+                this->state[1] ^= this->state[2];
+                this->state[0] ^= this->state[3];
+                this->state[2] ^= t;
+                this->state[3] = rotl(this->state[3], 45);
+
+                return result;
+            }
+
+            /**
+             * A uniformly distributed number from 0 to bound-1, without a division in the common case.
+             */
+            uint64_t below(uint64_t bound)
+            {
+                __uint128_t m = static_cast<__uint128_t>(this->next()) * bound;
+                uint64_t low = static_cast<uint64_t>(m);
+                if (low < bound) {
+                    //Reject the few values that would make the result uneven.
+                    uint64_t threshold = -bound % bound;
+                    while (low < threshold) {
+                        m = static_cast<__uint128_t>(this->next()) * bound;
+                        low = static_cast<uint64_t>(m);
+                    }
+                }
+                return m >> 64;
+            }
+
+        private:
+            uint64_t state[4];
+
+            static uint64_t rotl(uint64_t x, int k)
+            {
+                return (x << k) | (x >> (64 - k));
+            }
+    };
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "definitions.hh"
+#include "Random.hh"
+
+namespace Casspir
+{
+    /**
+     * Places an exact number of mines from a seed, shared by every board storage
+     * so the same seed and board always give the same layout.
+     */
+    namespace SeededMines
+    {
+        /**
+         * Find the n'th tile that isn't excluded.
+         *
+         * @param n
+         * @param excluded Excluded tile indices in ascending order.
+         * @param num_excluded
+         *
+         * @return The tile's index.
+         */
+        inline uint64_t skip_excluded(uint64_t n, const uint64_t* excluded, size_t num_excluded)
+        {
+            for (size_t i = 0; i < num_excluded && excluded[i] <= n; i++) {
+                n++;
+            }
+            return n;
+        }
+
+        /**
+         * Place mines sampled without replacement from the tiles outside the first flip's neighbourhood.
+         *
+         * @param mines A cleared plane to set the mines in, with get and set like Bitplane.
+         * @param size Tiles on the board.
+         * @param first_flip_index
+         * @param first_flip_neighbours
+         * @param num_mines Mines to place, limited to the tiles available.
+         * @param seed Seed for the mine placements.
+         *
+         * @return The number of mines placed.
+         */
+        template <typename Plane>
+        uint64_t place(
+            Plane& mines,
+            uint64_t size,
+            uint64_t first_flip_index,
+            const Neighbours& first_flip_neighbours,
+            uint64_t num_mines,
+            uint64_t seed
+        )
+        {
+            Random random(seed);
+
+            //The first flip and it's neighbours are kept clear, sorted so they can be skipped over.
+            uint64_t excluded[9];
+            size_t num_excluded = 0;
+            excluded[num_excluded++] = first_flip_index;
+            for (uint64_t neighbour : first_flip_neighbours) {
+                excluded[num_excluded++] = neighbour;
+            }
+            std::sort(excluded, excluded + num_excluded);
+
+            uint64_t available = size - num_excluded;
+            num_mines = std::min(num_mines, available);
+
+            //Floyd's algorithm, each step picks one of the first j+1 available tiles,
+            //taking the j'th instead if the pick is already a mine.
+            for (uint64_t j = available - num_mines; j < available; j++) {
+                uint64_t index = skip_excluded(random.below(j + 1), excluded, num_excluded);
+                if (mines.get(index)) {
+                    index = skip_excluded(j, excluded, num_excluded);
+                }
+                mines.set(index);
+            }
+
+            return num_mines;
+        }
+    }
+}
@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "BasicMap.hh"
+#include "Service.hh"
+#include "Solver.hh"
+#include "casspir.hh"
+
+using namespace Casspir;
+using namespace Casspir::ServiceFormat;
+
+//Boards bigger than this are refused, so responses stay under the message limit.
+static const uint64_t MAX_TILES = 1ULL << 26;
+
+/**
+ * Append a generate request to a message.
+ *
+ * @param message
+ * @param id Returned with the response.
+ * @param request
+ */
+void ServiceFormat::append_generate(std::vector<uint8_t>& message, uint64_t id, const GenerateRequest& request)
+{
+    RequestHeader header = {GENERATE, 0, id, sizeof(GenerateRequest)};
+    append(message, &header, 1);
+    append(message, &request, 1);
+}
+
+/**
+ * Append a solve or hint request to a message.
+ *
+ * @param message
+ * @param type SOLVE or HINT.
+ * @param id Returned with the response.
+ * @param board
+ * @param mines One bit per tile in index order, (width*height+63)/64 words.
+ * @param operations board.num_operations encoded operations, played after the click before solving.
+ */
+void ServiceFormat::append_board(
+    std::vector<uint8_t>& message,
+    RequestType type,
+    uint64_t id,
+    const BoardRequest& board,
+    const uint64_t* mines,
+    const uint64_t* operations
+) {
+    uint64_t num_words = (static_cast<uint64_t>(board.width) * board.height + 63) / 64;
+    uint64_t length = sizeof(BoardRequest) + (num_words + board.num_operations) * sizeof(uint64_t);
+    RequestHeader header = {type, 0, id, length};
+    append(message, &header, 1);
+    append(message, &board, 1);
+    append(message, mines, num_words);
+    append(message, operations, board.num_operations);
+}
+
+Service::Service()
+{
+}
+
+/**
+ * Handle a request and write the response.
+ * A request that can't be handled gets a BAD_REQUEST response with no body.
+ *
+ * @param request A whole request, header and body.
+ * @param size The request's size in bytes.
+ * @param response Replaced with the response.
+ *
+ * @return Whether the request was handled.
+ */
+bool Service::handle(const uint8_t* request, size_t size, std::vector<uint8_t>& response)
+{
+    auto start = std::chrono::steady_clock::now();
+    response.clear();
+
+    RequestHeader header = {0, 0, 0, 0};
+    if (size >= sizeof(RequestHeader)) {
+        header = read<RequestHeader>(request);
+    }
+
+    //Written now, then filled in once the body's done.
+    ResponseHeader response_header = {header.type, OK, header.id, 0, 0};
+    append(response, &response_header, 1);
+
+    bool handled = false;
+    if (size >= sizeof(RequestHeader) && header.length == size - sizeof(RequestHeader)) {
+        const uint8_t* body = request + sizeof(RequestHeader);
+        size_t body_size = header.length;
+        if (header.type == GENERATE) {
+            handled = this->generate(body, body_size, response);
+        } else if (header.type == SOLVE || header.type == HINT) {
+            handled = this->solve(body, body_size, response, header.type == HINT);
+        }
+    }
+
+    if (!handled) {
+        response.resize(sizeof(ResponseHeader));
+        response_header.status = BAD_REQUEST;
+    }
+
+    std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+    response_header.length = response.size() - sizeof(ResponseHeader);
+    response_header.service_ns = elapsed.count();
+    std::memcpy(response.data(), &response_header, sizeof(ResponseHeader));
+
+    return handled;
+}
+
+/**
+ * Generate the requested board and append it's mines to the response.
+ *
+ * @param map A map of the requested size to generate in.
+ * @param request
+ * @param response The response so far, the body is appended.
+ */
+template <typename M>
+static void append_generated(M& map, const GenerateRequest& request, std::vector<uint8_t>& response)
+{
+    map.generate_seeded(request.num_mines, Point(request.click_x, request.click_y), request.seed);
+
+    GenerateResponse generated = {map.get_total_mines(), 0};
+    append(response, &generated, 1);
+    for (uint64_t w = 0; w < map.get_mines().num_words(); w++) {
+        uint64_t word = map.get_mines().word(w);
+        append(response, &word, 1);
+    }
+}
+
+/**
+ * Generate a seeded board and respond with it's mines.
+ *
+ * @param body The request after the header.
+ * @param size
+ * @param response The response so far, the body is appended.
+ *
+ * @return false if the request isn't valid.
+ */
+bool Service::generate(const uint8_t* body, size_t size, std::vector<uint8_t>& response)
+{
+    if (size != sizeof(GenerateRequest)) {
+        return false;
+    }
+
+    GenerateRequest request = read<GenerateRequest>(body);
+    uint64_t tiles = static_cast<uint64_t>(request.width) * request.height;
+    if (tiles == 0 || tiles > MAX_TILES || request.click_x >= request.width || request.click_y >= request.height) {
+        return false;
+    }
+
+    //Standard boards are generated on the stack, anything else in a map of it's own size.
+    if (request.width == 9 && request.height == 9) {
+        BeginnerMap map;
+        append_generated(map, request, response);
+    } else if (request.width == 16 && request.height == 16) {
+        IntermediateMap map;
+        append_generated(map, request, response);
+    } else if (request.width == 30 && request.height == 16) {
+        ExpertMap map;
+        append_generated(map, request, response);
+    } else {
+        Map map(request.width, request.height, std::set<Point>());
+        append_generated(map, request, response);
+    }
+
+    return true;
+}
+
+/**
+ * Set up a board as played so far, then solve it or find the next move.
+ *
+ * @param body The request after the header.
+ * @param size
+ * @param response The response so far, the body is appended.
+ * @param hint Whether to only find the next move.
+ *
+ * @return false if the request isn't valid.
+ */
+bool Service::solve(const uint8_t* body, size_t size, std::vector<uint8_t>& response, bool hint)
+{
+    if (size < sizeof(BoardRequest)) {
+        return false;
+    }
+
+    BoardRequest request = read<BoardRequest>(body);
+    uint64_t tiles = static_cast<uint64_t>(request.width) * request.height;
+    if (tiles == 0 || tiles > MAX_TILES || request.click_x >= request.width || request.click_y >= request.height) {
+        return false;
+    }
+
+    uint64_t num_words = (tiles + 63) / 64;
+    if (request.num_operations > MAX_LENGTH / sizeof(uint64_t)
+    || size != sizeof(BoardRequest) + (num_words + request.num_operations) * sizeof(uint64_t)
+    ) {
+        return false;
+    }
+
+    //Copied out as the request needn't be aligned.
+    const uint8_t* words = body + sizeof(BoardRequest);
+    this->mines.resize(num_words);
+    std::memcpy(this->mines.data(), words, num_words * sizeof(uint64_t));
+
+    const uint8_t* played = words + num_words * sizeof(uint64_t);
+
+    //Standard sizes are played and solved on the stack.
+    if (request.width == 9 && request.height == 9) {
+        BeginnerMap map(this->mines.data());
+        return this->play(map, request, played, response, hint);
+    } else if (request.width == 16 && request.height == 16) {
+        IntermediateMap map(this->mines.data());
+        return this->play(map, request, played, response, hint);
+    } else if (request.width == 30 && request.height == 16) {
+        ExpertMap map(this->mines.data());
+        return this->play(map, request, played, response, hint);
+    }
+
+    Map map(request.width, request.height, this->mines.data());
+    return this->play(map, request, played, response, hint);
+}
+
+/**
+ * Replay the moves made so far on a board, then solve it or find the next move.
+ *
+ * @param map The board with the requested mines, nothing flipped.
+ * @param request
+ * @param played The request's encoded operations.
+ * @param response The response so far, the body is appended.
+ * @param hint Whether to only find the next move.
+ *
+ * @return false if an operation is off the board.
+ */
+template <typename M>
+bool Service::play(M& map, const BoardRequest& request, const uint8_t* played, std::vector<uint8_t>& response, bool hint)
+{
+    uint64_t tiles = map.get_size();
+    map.flip(Point(request.click_x, request.click_y));
+
+    for (uint64_t i = 0; i < request.num_operations; i++) {
+        uint64_t encoded = read<uint64_t>(played + i * sizeof(uint64_t));
+        if ((encoded >> 1) >= tiles) {
+            return false;
+        }
+
+        Operation operation = Operation::decode(encoded, request.width);
+        if (operation.type == OperationType::FLAG) {
+            map.flag(operation.position);
+        } else {
+            map.flip(operation.position);
+        }
+    }
+
+    BasicSolver<M> solver(map, this->context);
+    this->operations.clear();
+
+    if (hint) {
+        //The first move of the next step is the move solving would make.
+        HintResponse next = {0, 0, 0};
+        solver.step([&](const Operation& operation) {
+            if (!next.found) {
+                next.found = 1;
+                next.certain = solver.get_guesses() == 0;
+                next.operation = operation.encode(request.width);
+            }
+        });
+        append(response, &next, 1);
+        return true;
+    }
+
+    solver.solve([&](const Operation& operation) {
+        this->operations.push_back(operation.encode(request.width));
+    });
+
+    SolveResponse solved = {
+        static_cast<uint32_t>(map.get_status()),
+        0,
+        solver.get_guesses(),
+        this->operations.size()
+    };
+    append(response, &solved, 1);
+    append(response, this->operations.data(), this->operations.size());
+
+    return true;
+}
+
+Latencies::Latencies() : sorted(true)
+{
+}
+
+void Latencies::add(uint64_t ns)
+{
+    this->samples.push_back(ns);
+    this->sorted = false;
+}
+
+/**
+ * Add another set of latencies to these.
+ *
+ * @param other
+ */
+void Latencies::merge(const Latencies& other)
+{
+    this->samples.insert(this->samples.end(), other.samples.begin(), other.samples.end());
+    this->sorted = false;
+}
+
+size_t Latencies::size()
+{
+    return this->samples.size();
+}
+
+/**
+ * Get the latency that the given fraction of samples are at or under, by the nearest rank.
+ *
+ * @param p Fraction between 0 and 1, 0.5 for the median.
+ *
+ * @return The latency in nanoseconds, 0 if there are no samples.
+ */
+uint64_t Latencies::percentile(double p)
+{
+    if (this->samples.empty()) {
+        return 0;
+    }
+
+    if (!this->sorted) {
+        std::sort(this->samples.begin(), this->samples.end());
+        this->sorted = true;
+    }
+
+    double rank = std::ceil(p * this->samples.size());
+    size_t index = rank < 1 ? 0 : static_cast<size_t>(rank) - 1;
+    return this->samples[std::min(index, this->samples.size() - 1)];
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Map.hh"
+#include "SolverContext.hh"
+#include "definitions.hh"
+
+namespace Casspir
+{
+    /**
+     * Messages between casspir-server and it's clients, in native (little endian) byte order.
+     * Requests can be pipelined, responses carry the request's id and may come back in any order.
+     *
+     *   request   RequestHeader, then by type
+     *     GENERATE  GenerateRequest
+     *     SOLVE     BoardRequest, uint64 mine bitmap words, uint64 encoded operations already played
+     *     HINT      BoardRequest, uint64 mine bitmap words, uint64 encoded operations already played
+     *
+     *   response  ResponseHeader, then by type if the status is OK
+     *     GENERATE  GenerateResponse, uint64 mine bitmap words
+     *     SOLVE     SolveResponse, uint64 encoded operations
+     *     HINT      HintResponse
+     *
+     * Each header's length is the bytes of the message after it, everything is 8 byte aligned.
+     */
+    namespace ServiceFormat
+    {
+        enum RequestType : uint32_t {
+            GENERATE = 1,
+            SOLVE = 2,
+            HINT = 3
+        };
+
+        enum ResponseStatus : uint32_t {
+            OK = 0,
+            BAD_REQUEST = 1
+        };
+
+        //Messages longer than this are refused without being read.
+        const uint64_t MAX_LENGTH = 1ULL << 28;
+
+        struct RequestHeader {
+            uint32_t type;
+            uint32_t reserved;
+            uint64_t id;
+            uint64_t length;
+        };
+
+        struct ResponseHeader {
+            uint32_t type;
+            uint32_t status;
+            uint64_t id;
+            uint64_t length;
+
+            //Time spent handling the request, excluding queueing and transfer.
+            uint64_t service_ns;
+        };
+
+        struct GenerateRequest {
+            uint32_t width, height;
+            uint32_t click_x, click_y;
+            uint64_t num_mines;
+            uint64_t seed;
+        };
+
+        struct GenerateResponse {
+            uint64_t num_mines;
+            uint64_t reserved;
+        };
+
+        struct BoardRequest {
+            uint32_t width, height;
+            uint32_t click_x, click_y;
+            uint64_t num_operations;
+        };
+
+        struct SolveResponse {
+            uint32_t map_status;
+            uint32_t reserved;
+            uint64_t guesses;
+            uint64_t num_operations;
+        };
+
+        struct HintResponse {
+            uint32_t found;
+            uint32_t certain;
+            uint64_t operation;
+        };
+
+        /**
+         * Copy values onto the end of a message.
+         */
+        template<typename T>
+        void append(std::vector<uint8_t>& message, const T* values, size_t count)
+        {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values);
+            message.insert(message.end(), bytes, bytes + count * sizeof(T));
+        }
+
+        /**
+         * Copy a value out of a message, which needn't be aligned for it.
+         */
+        template<typename T>
+        T read(const uint8_t* bytes)
+        {
+            T value;
+            std::memcpy(&value, bytes, sizeof(T));
+            return value;
+        }
+
+        void append_generate(std::vector<uint8_t>& message, uint64_t id, const GenerateRequest& request);
+        void append_board(
+            std::vector<uint8_t>& message,
+            RequestType type,
+            uint64_t id,
+            const BoardRequest& board,
+            const uint64_t* mines,
+            const uint64_t* operations
+        );
+    }
+
+    /**
+     * Handles service requests, with storage kept between them.
+     * Not thread safe, give each thread it's own.
+     */
+    class Service
+    {
+        public:
+            Service();
+
+            bool handle(const uint8_t* request, size_t size, std::vector<uint8_t>& response);
+
+        private:
+            SolverContext context;
+            std::vector<uint64_t> mines, operations;
+
+            bool generate(const uint8_t* body, size_t size, std::vector<uint8_t>& response);
+            bool solve(const uint8_t* body, size_t size, std::vector<uint8_t>& response, bool hint);
+
+            template <typename M>
+            bool play(M& map, const ServiceFormat::BoardRequest& request, const uint8_t* played, std::vector<uint8_t>& response, bool hint);
+    };
+
+    /**
+     * Collects latencies to report percentiles of.
+     */
+    class Latencies
+    {
+        public:
+            Latencies();
+
+            void add(uint64_t ns);
+            void merge(const Latencies& other);
+
+            size_t size();
+            uint64_t percentile(double p);
+
+        private:
+            std::vector<uint64_t> samples;
+            bool sorted;
+    };
+}
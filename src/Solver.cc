@@ -1,74 +1,213 @@
+#include <algorithm>
 #include <iostream>
-#include <map>
 #include <random>
 
 #include "Solver.hh"
+#include "BasicMap.hh"
 #include "definitions.hh"
 
 using namespace Casspir;
 
-Solver::Solver(Map& map) : map(map)
+/**
+ * Prepare to solve a map.
+ *
+ * @param map The map to solve, it's played on directly.
+ * @param thread_pool Optional pool to evaluate groups on, not owned by the solver.
+ */
+template <typename M>
+BasicSolver<M>::BasicSolver(M& map, ThreadPool* thread_pool) : BasicSolver(map, *new SolverContext(), thread_pool)
+{
+    this->own_context.reset(this->context);
+}
+
+/**
+ * Prepare to solve a map with scratch storage kept from earlier solves.
+ *
+ * @param map The map to solve, it's played on directly.
+ * @param context Scratch storage, rebound to this map, which only this solver may use until it's done.
+ * @param thread_pool Optional pool to evaluate groups on, not owned by the solver.
+ */
+template <typename M>
+BasicSolver<M>::BasicSolver(M& map, SolverContext& context, ThreadPool* thread_pool)
+    : map(map), thread_pool(thread_pool), sink(nullptr), context(&context)
 {
-    this->map_size = this->map.get_width() * this->map.get_height();
+    this->map_size = this->map.get_size();
+    this->guesses = 0;
+    this->guess_limit = UINT64_MAX;
+    this->context->bind(this->map);
 
     this->random_engine.seed(41418740515);
     this->random_int = std::uniform_int_distribution<uint64_t>(
         0,
         this->map_size
     );
+
+    //Everything on the frontier is new to this solver.
+    this->map.mark_frontier_dirty();
 }
 
-std::queue<Operation> Solver::solve()
+/**
+ * Play the map until it's complete, failed, or the guess limit is passed.
+ *
+ * @return A list of tile operations in sequence.
+ */
+template <typename M>
+std::queue<Operation> BasicSolver<M>::solve()
 {
-    bool did_something = false;
-    do {
-        //Try basic
-        if (!this->perform_basic_pass()) {
-            //Try permutation
-            if (!this->enumerate_groups()) {
-                //Do random
-                this->flip_random_tile();
+    std::queue<Operation> operations;
+    this->solve([&operations](const Operation& operation) {
+        operations.push(operation);
+    });
+
+    return operations;
+}
+
+/**
+ * Play the map until it's complete, failed, or the guess limit is passed,
+ * handing each operation to the sink as soon as it's made rather than collecting them.
+ *
+ * @param sink Called with each tile operation in sequence.
+ */
+template <typename M>
+void BasicSolver<M>::solve(const OperationSink& sink)
+{
+    this->sink = &sink;
+
+    while (this->map.get_status() == MapStatus::IN_PROGRESS && this->guesses <= this->guess_limit) {
+        this->take_step();
+    }
+
+    this->sink = nullptr;
+}
+
+/**
+ * Make one round of moves, those of the first technique that finds any, guessing if none do.
+ * Solving is a series of steps, so a step's first move is the move solving would make next.
+ *
+ * @param sink Called with each tile operation in sequence.
+ */
+template <typename M>
+void BasicSolver<M>::step(const OperationSink& sink)
+{
+    if (this->map.get_status() != MapStatus::IN_PROGRESS) {
+        return;
+    }
+
+    this->sink = &sink;
+    this->take_step();
+    this->sink = nullptr;
+}
+
+/**
+ * Try each technique in turn, from cheapest to most expensive, until one makes a move.
+ */
+template <typename M>
+void BasicSolver<M>::take_step()
+{
+    //Try basic
+    if (!this->perform_basic_pass()) {
+        //Try pairs
+        if (!this->perform_pair_pass()) {
+            //Try elimination
+            if (!this->perform_elimination_pass()) {
+                //Try permutation
+                if (!this->enumerate_groups()) {
+                    //Do random
+                    this->flip_random_tile();
+                }
             }
         }
-    } while (this->map.get_status() == MapStatus::IN_PROGRESS);
+    }
+}
+
+/**
+ * Get the number of flips made without certainty that the tile was safe.
+ *
+ * @return guesses
+ */
+template <typename M>
+uint64_t BasicSolver<M>::get_guesses()
+{
+    return this->guesses;
+}
+
+/**
+ * Stop solving once more than this many guesses have been made.
+ *
+ * @param guess_limit
+ */
+template <typename M>
+void BasicSolver<M>::set_guess_limit(uint64_t guess_limit)
+{
+    this->guess_limit = guess_limit;
+}
 
-    return this->operations;
+/**
+ * Get the counts and times of the work done so far.
+ * Everything is 0 unless built with solver statistics enabled.
+ *
+ * @return stats
+ */
+template <typename M>
+const SolverStats& BasicSolver<M>::get_stats()
+{
+    return this->stats;
 }
 
-void Solver::flip_random_tile()
+/**
+ * Flip a random unflipped tile.
+ */
+template <typename M>
+void BasicSolver<M>::flip_random_tile()
 {
+    CASSPIR_STAT(PhaseTimer timer(this->stats.random_flip));
+    this->guesses++;
     uint64_t random_index = this->random_int(this->random_engine) % (this->map_size - this->map.get_num_flipped());
 
-    uint64_t index = 0;
-    for (uint64_t i=0; i < this->map_size; i++) {
-        TileState tile = this->map.get_tile(i);
-        if (!tile.flipped) {
-            if (index == random_index) {
-                this->flip(Point::from_index(i, this->map.get_width()));
-                return;
-            }
-            index++;
+    //Skip whole words of the flip plane until the word holding the chosen unflipped tile.
+    const auto& flipped = this->map.get_flipped();
+    for (uint64_t w = 0; w < flipped.num_words(); w++) {
+        uint64_t unflipped = ~flipped.word(w) & flipped.word_mask(w);
+        uint64_t count = __builtin_popcountll(unflipped);
+        if (random_index >= count) {
+            random_index -= count;
+            continue;
+        }
+
+        //Drop the lowest set bits until the chosen one is lowest.
+        for (; random_index > 0; random_index--) {
+            unflipped &= unflipped - 1;
         }
+        uint64_t index = w * 64 + __builtin_ctzll(unflipped);
+        this->flip(Point::from_index(index, this->map.get_width()));
+        return;
     }
 }
 
 /**
- * Loop over each tile and evaluate each once.
+ * Evaluate each frontier tile whose neighbourhood changed since the last pass.
+ * Tiles changed during the pass are picked up by the next one.
  *
  * @return true if an action was performed.
  */
-bool Solver::perform_basic_pass()
+template <typename M>
+bool BasicSolver<M>::perform_basic_pass()
 {
+    CASSPIR_STAT(PhaseTimer timer(this->stats.basic_pass));
     bool did_something = false;
 
-    for (uint64_t i=0; i < this->map_size; i++) {
-        TileState tile = this->map.get_tile(i);
-        if (tile.flipped && tile.value > 0) {
-            did_something |= this->evaluate_neighbours(i);
+    this->map.take_dirty_tiles(this->context->worklist);
+    for (uint64_t i : this->context->worklist) {
+        //Earlier moves in this pass may have resolved the tile already.
+        if (!this->map.is_frontier(i)) {
+            continue;
+        }
 
-            if (this->map.get_status() != MapStatus::IN_PROGRESS) {
-                break;
-            }
+        CASSPIR_STAT(this->stats.tiles_scanned++);
+        did_something |= this->evaluate_neighbours(i);
+
+        if (this->map.get_status() != MapStatus::IN_PROGRESS) {
+            break;
         }
     }
 
@@ -82,32 +221,31 @@ bool Solver::perform_basic_pass()
  *
  * @return true if an action was performed.
  */
-bool Solver::evaluate_neighbours(uint64_t index)
+template <typename M>
+bool BasicSolver<M>::evaluate_neighbours(uint64_t index)
 {
     bool did_something = false;
-    TileState tile = this->map.get_tile(index);
+    uint8_t value = this->map.get_value(index);
     Point tile_position = Point::from_index(index, this->map.get_width());
 
-    std::set<Point> neighbours = this->map.get_neighbours(tile_position);
+    Neighbours neighbours = this->map.get_neighbours(index);
 
     //Count the flagged and unflipped neighbours
     uint8_t flagged = 0;
     uint8_t unflipped = 0;
-    for (const auto& neighbour : neighbours) {
-        TileState neighbour_tile = this->map.get_tile(neighbour);
-        flagged += (neighbour_tile.flagged);
-        unflipped += (!neighbour_tile.flipped);
+    for (uint64_t neighbour : neighbours) {
+        flagged += this->map.is_flagged(neighbour);
+        unflipped += !this->map.is_flipped(neighbour);
     }
 
-    if (flagged == tile.value && unflipped - flagged > 0) {
+    if (flagged == value && unflipped - flagged > 0) {
         //If this tile's values is satisfied by flagged neighbours, flip the rest
         did_something |= this->flip(tile_position);
-    } else if (unflipped == tile.value) {
+    } else if (unflipped == value) {
         //Otherwise if the number of unflipped match the tiles value, then flag the unflipped.
-        for (const auto& neighbour : neighbours) {
-            TileState neighbour_tile = this->map.get_tile(neighbour);
-            if (!neighbour_tile.flagged && !neighbour_tile.flipped) {
-                did_something |= this->flag(neighbour);
+        for (uint64_t neighbour : neighbours) {
+            if (!this->map.is_flagged(neighbour) && !this->map.is_flipped(neighbour)) {
+                did_something |= this->flag(Point::from_index(neighbour, this->map.get_width()));
             }
         }
     }
@@ -116,165 +254,453 @@ bool Solver::evaluate_neighbours(uint64_t index)
 }
 
 /**
- * Find all groups of tiles.
+ * Compare each frontier tile with the frontier tiles near enough to share unflipped neighbours.
+ * The mines two tiles share are bounded by both their values,
+ * which can force the tiles only one of them touches to be all safe or all mines.
  *
- * @return Whether a move was taken.
+ * @return true if an action was performed.
  */
-bool Solver::enumerate_groups()
+template <typename M>
+bool BasicSolver<M>::perform_pair_pass()
 {
-    TileState tile;
-    Point tile_position;
-    std::set<Point> neighbours;
-    std::set<Point> considered;
-    std::set< std::pair< Point, float> > candidates;
-
-    //If the number of remaining tiles is less than 20,
-    //just evaluate all of them.
-    if (this->map_size - this->map.get_num_flipped() < 20) {
-        std::set<Point> border_unflipped;
-        std::set<Point> border_flipped;
-
-        for (uint64_t i=0; i < this->map_size; i++) {
-            tile = this->map.get_tile(i);
-            tile_position = Point::from_index(i, this->map.get_width());
-            if (!tile.flipped) {
-                border_unflipped.insert(tile_position);
-                neighbours = this->map.get_neighbours(tile_position);
-
-                for (Point neighbour : neighbours) {
-                    TileState neighbour_tile = this->map.get_tile(neighbour);
-                    if (neighbour_tile.flipped) {
-                        border_flipped.insert(neighbour);
+    CASSPIR_STAT(PhaseTimer timer(this->stats.pair_pass));
+    bool did_something = false;
+    uint32_t width = this->map.get_width();
+    uint32_t height = this->map.get_height();
+
+    const auto& frontier = this->map.get_frontier();
+    for (uint64_t w = 0; w < frontier.num_words(); w++) {
+        for (uint64_t bits = frontier.word(w); bits != 0; bits &= bits - 1) {
+            uint64_t a = w * 64 + __builtin_ctzll(bits);
+            uint32_t ax = a % width;
+            uint32_t ay = a / width;
+
+            //Partners within two tiles, so their neighbourhoods overlap.
+            for (uint32_t by = ay < 2 ? 0 : ay - 2; by <= ay + 2 && by < height; by++) {
+                for (uint32_t bx = ax < 2 ? 0 : ax - 2; bx <= ax + 2 && bx < width; bx++) {
+                    uint64_t b = static_cast<uint64_t>(by) * width + bx;
+                    if (b == a || !this->map.is_frontier(a) || !this->map.is_frontier(b)) {
+                        continue;
+                    }
+
+                    CASSPIR_STAT(this->stats.pairs_compared++);
+                    did_something |= this->evaluate_pair(a, b);
+
+                    if (this->map.get_status() != MapStatus::IN_PROGRESS) {
+                        return did_something;
                     }
                 }
             }
         }
+    }
 
-        candidates = this->evaluate_group(border_unflipped, border_flipped);
-    } else {
-        //Loop over each tile and consider it's group.
-        for (uint64_t i=0; i < this->map_size; i++) {
-            tile = this->map.get_tile(i);
-            if (tile.flipped) {
-                continue;
-            }
+    return did_something;
+}
 
-            tile_position = Point::from_index(i, this->map.get_width());
+/**
+ * See if comparing two frontier tiles shows the tiles only the second one touches are all safe or all mines.
+ *
+ * @param a The first tile's index.
+ * @param b The second tile's index, within two tiles of the first.
+ *
+ * @return true if an action was performed.
+ */
+template <typename M>
+bool BasicSolver<M>::evaluate_pair(uint64_t a, uint64_t b)
+{
+    uint32_t width = this->map.get_width();
+    int8_t needed_a, needed_b;
+    uint64_t unknown_a = this->unknown_window(a, a, needed_a);
+    uint64_t unknown_b = this->unknown_window(b, a, needed_b);
+
+    uint64_t shared = unknown_a & unknown_b;
+    uint64_t only_b = unknown_b & ~unknown_a;
+    if (shared == 0 || only_b == 0) {
+        return false;
+    }
 
-            if (considered.count(tile_position) > 0) {
-                continue;
-            }
+    int8_t num_shared = __builtin_popcountll(shared);
+    int8_t num_only_a = __builtin_popcountll(unknown_a & ~unknown_b);
+    int8_t num_only_b = __builtin_popcountll(only_b);
 
-            std::set<Point> border_unflipped;
-            std::set<Point> border_flipped;
+    //The most and fewest mines the shared tiles can hold, as far as a can tell.
+    int8_t most_shared = std::min(num_shared, needed_a);
+    int8_t fewest_shared = std::max<int8_t>(0, needed_a - num_only_a);
 
-            this->recursive_border_search(tile_position, border_unflipped, border_flipped);
-            considered.insert(border_unflipped.begin(), border_unflipped.end());
+    bool mines;
+    if (needed_b - most_shared == num_only_b) {
+        mines = true;
+    } else if (needed_b - fewest_shared <= 0) {
+        mines = false;
+    } else {
+        return false;
+    }
 
-            if (border_unflipped.size() > 0 && border_unflipped.size() < 20) {
-                std::set< std::pair< Point, float > > nominations = this->evaluate_group(
-                    border_unflipped,
-                    border_flipped
-                );
-                candidates.insert(nominations.begin(), nominations.end());
-            }
+    //Act on each tile only b touches, the window is centred on a.
+    int64_t ax = a % width;
+    int64_t ay = a / width;
+    bool did_something = false;
+    for (; only_b != 0; only_b &= only_b - 1) {
+        int64_t bit = __builtin_ctzll(only_b);
+        Point position(ax + bit % 7 - 3, ay + bit / 7 - 3);
+        if (mines) {
+            did_something |= this->flag(position);
+        } else {
+            did_something |= this->flip(position);
         }
     }
 
-    float min_risk = 1.;
-    Point min_risk_point;
-    bool min_risk_point_found = false;
-    bool zero_risk_flip = false;
-    for (const auto& candidate : candidates) {
-        if (candidate.second == 0) {
-            this->flip(candidate.first);
-            zero_risk_flip = true;
+    return did_something;
+}
+
+/**
+ * Find the unflipped, unflagged neighbours of a numbered tile
+ * as bits of the 7x7 window centred on another tile.
+ *
+ * @param index The numbered tile.
+ * @param centre The window's centre tile, within two tiles of index.
+ * @param needed Set to the mines still needed around the numbered tile.
+ *
+ * @return The window bits of the neighbours, bit (dy+3)*7 + (dx+3) for offset dx,dy from the centre.
+ */
+template <typename M>
+uint64_t BasicSolver<M>::unknown_window(uint64_t index, uint64_t centre, int8_t& needed)
+{
+    uint32_t width = this->map.get_width();
+    int64_t cx = centre % width;
+    int64_t cy = centre / width;
+
+    uint64_t window = 0;
+    needed = this->map.get_value(index);
+    for (uint64_t neighbour : this->map.get_neighbours(index)) {
+        if (this->map.is_flagged(neighbour)) {
+            needed--;
+        } else if (!this->map.is_flipped(neighbour)) {
+            int64_t dx = static_cast<int64_t>(neighbour % width) - cx;
+            int64_t dy = static_cast<int64_t>(neighbour / width) - cy;
+            window |= 1ULL << ((dy + 3) * 7 + (dx + 3));
+        }
+    }
+
+    return window;
+}
+
+/**
+ * Reduce the equations of each frontier component and act on every tile they decide.
+ * Works on components of any size in polynomial time, so what it decides is left out of enumeration.
+ *
+ * @return true if an action was performed.
+ */
+template <typename M>
+bool BasicSolver<M>::perform_elimination_pass()
+{
+    CASSPIR_STAT(PhaseTimer timer(this->stats.elimination_pass));
+    uint32_t width = this->map.get_width();
+    SolverContext& context = *this->context;
+
+    //Decide every component before moving, as flips can flood into other components.
+    //Enumeration only follows if nothing moves, so it uses these components too.
+    context.components.compute(this->map);
+    context.safe.clear();
+    context.mines.clear();
+    for (size_t c = 0; c < context.components.size(); c++) {
+        context.equations.reduce(
+            this->map,
+            context.components.get_cells(c),
+            context.components.get_num_cells(c),
+            context.components.get_numbers(c),
+            context.components.get_num_numbers(c)
+        );
+        if (!context.equations.is_consistent()) {
             continue;
         }
 
-        if (!min_risk_point_found || candidate.second < min_risk) {
-            min_risk = candidate.second;
-            min_risk_point = candidate.first;
-            min_risk_point_found = true;
+        const std::vector<uint64_t>& safe = context.equations.get_safe();
+        const std::vector<uint64_t>& mines = context.equations.get_mines();
+        context.safe.insert(context.safe.end(), safe.begin(), safe.end());
+        context.mines.insert(context.mines.end(), mines.begin(), mines.end());
+    }
+    CASSPIR_STAT(this->stats.tiles_eliminated += context.safe.size() + context.mines.size());
+
+    bool did_something = false;
+    for (uint64_t index : context.mines) {
+        did_something |= this->flag(Point::from_index(index, width));
+    }
+    for (uint64_t index : context.safe) {
+        did_something |= this->flip(Point::from_index(index, width));
+        if (this->map.get_status() != MapStatus::IN_PROGRESS) {
+            break;
         }
     }
 
-    return zero_risk_flip || (min_risk_point_found && this->flip(min_risk_point));
+    return did_something;
 }
 
-std::set< std::pair< Point, float > > Solver::evaluate_group(
-    const std::set<Point> border_unflipped,
-    const std::set<Point> border_flipped
-) {
-    Map staging_map = this->map;
-    uint64_t max_mines = std::min(this->map.get_mines_remaining(), border_unflipped.size());
-    uint64_t mines = 0;
-    uint64_t max = 1 << border_unflipped.size();
-    std::map<Point, uint64_t> tallies;
-    uint64_t total_valid_permutations = 0;
-
-    for (Point position : border_unflipped) {
-        tallies.insert(std::pair<Point, uint64_t>(position, 0));
-    }
-
-    for (uint64_t i = 0; i < max; i++) {
-        mines = 0;
-        uint64_t j = 0;
-        for (Point position : border_unflipped) {
-            if (i & (1 << j)) {
-                //set flag
-                staging_map.get_tile(position).flagged = true;
-
-                //Skip if too many mines are used
-                if (++mines > max_mines) {
-                    //mfw
-                    goto double_break;
-                }
-            } else {
-                //unset flag
-                staging_map.get_tile(position).flagged = false;
-            }
-            j++;
+/**
+ * Find all groups of tiles and work out the chance of a mine in every unflipped tile.
+ * Certain mines are flagged and certain safe tiles flipped,
+ * otherwise the least risky tile is flipped as a guess.
+ * Runs after an elimination pass that made no move, so the components it found are still current.
+ *
+ * @return Whether a move was taken.
+ */
+template <typename M>
+bool BasicSolver<M>::enumerate_groups()
+{
+    CASSPIR_STAT(PhaseTimer timer(this->stats.enumerate_groups));
+    uint32_t width = this->map.get_width();
+    SolverContext& context = *this->context;
+    std::vector<FrontierGroup>& groups = context.groups;
+
+    //Keep the last call's groups for their storage, in order so each group reuses the same one.
+    for (size_t g = groups.size(); g-- > 0;) {
+        context.spare_groups.push_back(std::move(groups[g]));
+    }
+    groups.clear();
+
+    //Each component of the frontier is a group, unless it's too big to enumerate.
+    for (size_t c = 0; c < context.components.size(); c++) {
+        size_t num_cells = context.components.get_num_cells(c);
+        if (num_cells > MAX_GROUP_SIZE) {
+            CASSPIR_STAT(this->stats.groups_skipped++);
+            continue;
         }
 
-        //check if flipped tiles are satisfied
-        for (Point position : border_flipped) {
-            //If not, move onto the next number
-            if (!staging_map.is_tile_satisfied(position)) {
-                goto double_break;
+        if (context.spare_groups.empty()) {
+            groups.emplace_back();
+        } else {
+            groups.push_back(std::move(context.spare_groups.back()));
+            context.spare_groups.pop_back();
+        }
+        FrontierGroup& group = groups.back();
+        group.build(
+            this->map,
+            context.components.get_cells(c),
+            num_cells,
+            context.components.get_numbers(c),
+            context.components.get_num_numbers(c),
+            context.group_scratch
+        );
+
+        //Take the counts of the same group from the last call, if it's unchanged.
+        std::vector< std::pair<uint64_t, size_t> >& signatures = context.cached_signatures;
+        auto match = std::lower_bound(signatures.begin(), signatures.end(), std::make_pair(group.get_signature(), size_t(0)));
+        for (; match != signatures.end() && match->first == group.get_signature(); match++) {
+            FrontierGroup& cached = context.cached_groups[match->second];
+            if (cached.has_same_constraints(group)) {
+                group.copy_counts(cached);
+                CASSPIR_STAT(this->stats.groups_reused++);
+                break;
             }
         }
-        total_valid_permutations++;
+    }
 
-        //if they are add a point to the tiles tally if it has a flag on it
-        for (Point position : border_unflipped) {
-            if (staging_map.get_tile(position).flagged) {
-                tallies[position]++;
+    //Groups don't share any numbers, so they're solved independently
+    //and then combined over the remaining mine count.
+    this->evaluate_groups(groups);
+    this->cache_groups();
+
+    //Groups that ran out of work are dropped like the groups too big to enumerate,
+    //they stay cached as exhausted so they aren't searched again while unchanged.
+    size_t kept = 0;
+    for (size_t g = 0; g < groups.size(); g++) {
+        if (groups[g].is_exhausted()) {
+            CASSPIR_STAT(this->stats.groups_skipped++);
+            continue;
+        }
+        if (kept != g) {
+            std::swap(groups[kept], groups[g]);
+        }
+        kept++;
+    }
+    for (size_t g = groups.size(); g-- > kept;) {
+        context.spare_groups.push_back(std::move(groups[g]));
+    }
+    groups.resize(kept);
+
+    //Tiles in dropped groups are treated as unconstrained, like the interior.
+    context.grouped.clear();
+    for (FrontierGroup& group : groups) {
+        for (size_t i = 0; i < group.size(); i++) {
+            context.grouped.push_back(group.get_cell(i));
+        }
+    }
+    std::sort(context.grouped.begin(), context.grouped.end());
+    uint64_t grouped_count = context.grouped.size();
+
+    uint64_t mines_remaining = this->map.get_mines_remaining();
+    uint64_t flags = this->map.get_total_mines() - mines_remaining;
+    uint64_t interior = this->map_size - this->map.get_num_flipped() - flags - grouped_count;
+
+    context.probabilities.compute(groups, interior, mines_remaining);
+    if (!context.probabilities.is_consistent()) {
+        return false;
+    }
+
+    //Flag the certain mines and collect the certain safe tiles, in the order the groups were found.
+    bool did_something = false;
+    std::vector<uint64_t>& safe = context.safe;
+    safe.clear();
+    double min_risk = 1.;
+    uint64_t min_risk_index = 0;
+    bool min_risk_found = false;
+    for (size_t g = 0; g < groups.size(); g++) {
+        for (size_t i = 0; i < groups[g].size(); i++) {
+            uint64_t index = groups[g].get_cell(i);
+            double probability = context.probabilities.get_probability(g, i);
+            if (probability == 0) {
+                safe.push_back(index);
+            } else if (probability == 1) {
+                did_something |= this->flag(Point::from_index(index, width));
+            } else if (!min_risk_found || probability < min_risk) {
+                min_risk = probability;
+                min_risk_index = index;
+                min_risk_found = true;
             }
         }
+    }
 
-        double_break:;
-    }
-
-    //Flag those that always had a flag when satisfied.
-    //Flip those that never had a flag when satisfied.
-    Point min_point;
-    uint64_t min_value = total_valid_permutations+1;
-    std::set< std::pair< Point, float > > nominations;
-    for (auto& kv : tallies) {
-        if (kv.second == 0) {
-            nominations.insert(std::pair<Point, float>(kv.first, static_cast<float>(kv.second)/total_valid_permutations));
-        } else if (kv.second == total_valid_permutations) {
-            this->flag(kv.first);
-        } else if (kv.second < min_value) {
-            min_value = kv.second;
-            min_point = kv.first;
+    //Only the mine count can make the interior certain, then it's all one way.
+    double interior_probability = context.probabilities.get_interior_probability();
+    if (interior > 0 && interior_probability == 0) {
+        for (uint64_t n = 0; n < interior; n++) {
+            safe.push_back(this->nth_interior_tile(n));
+        }
+    } else if (interior > 0 && interior_probability == 1) {
+        //Flagging takes the tile out of the interior, so the first is always the next.
+        for (uint64_t n = 0; n < interior; n++) {
+            did_something |= this->flag(Point::from_index(this->nth_interior_tile(0), width));
         }
     }
 
-    nominations.insert(std::pair<Point, float>(min_point, static_cast<float>(min_value)/total_valid_permutations));
+    for (uint64_t index : safe) {
+        did_something |= this->flip(Point::from_index(index, width));
+    }
+
+    if (did_something || this->map.get_status() != MapStatus::IN_PROGRESS) {
+        return did_something;
+    }
+
+    //Nothing is certain, guess the least likely mine.
+    //Any interior tile is as good as another so pick one at random.
+    this->guesses++;
+    if (interior > 0 && (!min_risk_found || interior_probability < min_risk)) {
+        uint64_t n = this->random_int(this->random_engine) % interior;
+        return this->flip(Point::from_index(this->nth_interior_tile(n), width));
+    }
 
-    return nominations;
+    if (min_risk_found) {
+        return this->flip(Point::from_index(min_risk_index, width));
+    }
+
+    return false;
+}
+
+/**
+ * Copy the groups just enumerated to reuse the counts of any that are unchanged next time.
+ * Copies are made into the same cache slot each time, so they don't allocate once the slots have grown.
+ */
+template <typename M>
+void BasicSolver<M>::cache_groups()
+{
+    SolverContext& context = *this->context;
+    std::vector<FrontierGroup>& groups = context.groups;
+
+    if (context.cached_groups.size() < groups.size()) {
+        context.cached_groups.resize(groups.size());
+    }
+
+    context.cached_signatures.clear();
+    for (size_t g = 0; g < groups.size(); g++) {
+        context.cached_groups[g] = groups[g];
+        context.cached_signatures.emplace_back(groups[g].get_signature(), g);
+    }
+    std::sort(context.cached_signatures.begin(), context.cached_signatures.end());
+}
+
+/**
+ * Find an unflipped, unflagged tile outside the enumerated groups.
+ *
+ * @param n Which of them, in index order.
+ *
+ * @return The tile's index, or the map size if there aren't that many.
+ */
+template <typename M>
+uint64_t BasicSolver<M>::nth_interior_tile(uint64_t n)
+{
+    const auto& flipped = this->map.get_flipped();
+    const auto& flagged = this->map.get_flagged();
+    const std::vector<uint64_t>& grouped = this->context->grouped;
+
+    //Skip whole words until the one holding the chosen tile, masking out the grouped cells in each as it's passed.
+    size_t g = 0;
+    for (uint64_t w = 0; w < flipped.num_words(); w++) {
+        uint64_t excluded = flipped.word(w) | flagged.word(w);
+        for (; g < grouped.size() && grouped[g] < (w + 1) * 64; g++) {
+            excluded |= 1ULL << (grouped[g] % 64);
+        }
+        uint64_t interior = ~excluded & flipped.word_mask(w);
+        uint64_t count = __builtin_popcountll(interior);
+        if (n >= count) {
+            n -= count;
+            continue;
+        }
+
+        //Drop the lowest set bits until the chosen one is lowest.
+        for (; n > 0; n--) {
+            interior &= interior - 1;
+        }
+        return w * 64 + __builtin_ctzll(interior);
+    }
+
+    return this->map_size;
+}
+
+/**
+ * Count the mine assignments of each group that satisfy their flipped neighbours.
+ * Uses the thread pool if there is one, the result is the same either way.
+ *
+ * @param groups The groups to enumerate.
+ */
+template <typename M>
+void BasicSolver<M>::evaluate_groups(std::vector<FrontierGroup>& groups)
+{
+    uint64_t mines_remaining = this->map.get_mines_remaining();
+
+    //Each group is timed separately so threads don't share counters.
+    CASSPIR_STAT(std::vector<PhaseStats> group_stats(groups.size()));
+    auto evaluate = [&](size_t i) {
+        //Groups carried over from the last call are already counted.
+        uint64_t max_mines = std::min<uint64_t>(mines_remaining, groups[i].size());
+        if (groups[i].is_enumerated(max_mines)) {
+            return;
+        }
+
+        CASSPIR_STAT(PhaseTimer timer(group_stats[i]));
+        groups[i].enumerate(max_mines, MAX_GROUP_WORK);
+    };
+
+    if (this->thread_pool != nullptr) {
+        this->thread_pool->parallel_for(groups.size(), evaluate);
+    } else {
+        for (size_t i = 0; i < groups.size(); i++) {
+            evaluate(i);
+        }
+    }
+
+    CASSPIR_STAT(
+        this->stats.group_sizes.resize(MAX_GROUP_SIZE + 1);
+        for (size_t i = 0; i < groups.size(); i++) {
+            if (group_stats[i].calls == 0) {
+                continue;
+            }
+            this->stats.evaluate_group.calls += group_stats[i].calls;
+            this->stats.evaluate_group.seconds += group_stats[i].seconds;
+            this->stats.group_sizes[groups[i].size()]++;
+            this->stats.assignments_tried += groups[i].get_assignments_tried();
+            this->stats.assignments_accepted += groups[i].get_solutions();
+        }
+    )
 }
 
 /**
@@ -284,11 +710,12 @@ std::set< std::pair< Point, float > > Solver::evaluate_group(
  *
  * @return true if an action was performed.
  */
-bool Solver::flip(Point position)
+template <typename M>
+bool BasicSolver<M>::flip(Point position)
 {
     //Add the operation to the solution only if anything was actually flipped.
     if (this->map.flip(position) > 0) {
-        this->operations.push(Operation(OperationType::FLIP, position));
+        this->emit(Operation(OperationType::FLIP, position));
         return true;
     }
     return false;
@@ -301,71 +728,30 @@ bool Solver::flip(Point position)
  *
  * @return true if an action was performed.
  */
-bool Solver::flag(Point position)
+template <typename M>
+bool BasicSolver<M>::flag(Point position)
 {
     this->map.flag(position);
-    this->operations.push(Operation(OperationType::FLAG, position));
+    this->emit(Operation(OperationType::FLAG, position));
     return true;
 }
 
 /**
- * Recursively search through the game space looking for a contiguous set of unflipped border tiles.
- * Border tiles being those that have a flipped tile as a neighbour.
+ * Hand an operation to the sink.
+ * Moves made outside of solve, with no sink, aren't recorded.
  *
- * @param position The starting position
- * @param border_unflipped A set to fill with unflipped tiles that make up the group.
- * @param border_flipped A set to fill with flipped neighbours of the unflipped tiles.
+ * @param operation
  */
-void Solver::recursive_border_search(
-    Point position,
-    std::set<Point>& border_unflipped,
-    std::set<Point>& border_flipped
-) {
-    //Check if the tile is flipped, meaning it's not a border tile.
-    TileState tile = this->map.get_tile(position);
-    if (tile.flipped || tile.flagged) {
-        return;
-    }
-
-    //Check if this tile has already been considered during the search
-    if (border_unflipped.count(position) > 0) {
-        return;
-    }
-
-    //Search the neighbors for a flipped tile, confirming that this is a border tile.
-    bool is_border_tile = false;
-    std::set<Point> neighbours = this->map.get_neighbours(position);
-    std::set<Point> flipped_neighbours;
-    for (const auto& neighbour : neighbours) {
-        TileState neighbour_tile = this->map.get_tile(neighbour);
-
-        //Border tile confirmed
-        if (!is_border_tile) {
-            if (neighbour_tile.flipped) {
-                border_unflipped.insert(position);
-                is_border_tile = true;
-            }
-        }
-
-        //Keep track of which neighbours are flipped.
-        if (neighbour_tile.flipped) {
-            border_flipped.insert(neighbour);
-            flipped_neighbours.insert(neighbour);
-        }
-    }
-
-    if (is_border_tile) {
-        //Recurse into the border tiles neighbours to find the rest of the border
-        for (const auto& neighbour : flipped_neighbours) {
-
-            //Recurse into the unflipped neighbours of the flipped ones
-            std::set<Point> candidate_neighbours = this->map.get_neighbours(neighbour);
-            for (const auto& candidate_neighbour : candidate_neighbours) {
-                this->recursive_border_search(candidate_neighbour, border_unflipped, border_flipped);
-            }
-
-        }
+template <typename M>
+void BasicSolver<M>::emit(const Operation& operation)
+{
+    if (this->sink != nullptr) {
+        (*this->sink)(operation);
     }
+}
 
-    return;
-}
\ No newline at end of file
+//Each board the solver is built for.
+template class Casspir::BasicSolver<Map>;
+template class Casspir::BasicSolver<BeginnerMap>;
+template class Casspir::BasicSolver<IntermediateMap>;
+template class Casspir::BasicSolver<ExpertMap>;
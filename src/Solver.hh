@@ -7,41 +7,78 @@
 #include <chrono>
 
 #include "Map.hh"
+#include "FrontierGroup.hh"
+#include "MineProbabilities.hh"
+#include "SolverContext.hh"
+#include "ThreadPool.hh"
+#include "SolverStats.hh"
 #include "definitions.hh"
 
 namespace Casspir
 {
-    class Solver
+    /**
+     * Plays a board to the end, making every certain move and guessing the least risky tile when there are none.
+     * Built for Map, as Solver, and for each standard BasicMap so those can be solved on the stack.
+     */
+    template <typename M>
+    class BasicSolver
     {
         public:
-            Solver(Map& map);
+            BasicSolver(M& map, ThreadPool* thread_pool = nullptr);
+            BasicSolver(M& map, SolverContext& context, ThreadPool* thread_pool = nullptr);
             std::queue<Operation> solve();
+            void solve(const OperationSink& sink);
+            void step(const OperationSink& sink);
+
+            uint64_t get_guesses();
+            void set_guess_limit(uint64_t guess_limit);
+            const SolverStats& get_stats();
 
         protected:
-            Map& map;
+            M& map;
+            ThreadPool* thread_pool;
             uint64_t map_size;
-            std::queue<Operation> operations;
+            const OperationSink* sink;
             std::default_random_engine random_engine;
             std::uniform_int_distribution<uint64_t> random_int;
+            uint64_t guesses, guess_limit;
+            SolverStats stats;
+
+            //Scratch storage, the solver's own unless one is given.
+            std::unique_ptr<SolverContext> own_context;
+            SolverContext* context;
+
+            void take_step();
 
             bool perform_basic_pass();
             bool evaluate_neighbours(uint64_t index);
 
+            bool perform_pair_pass();
+            bool evaluate_pair(uint64_t a, uint64_t b);
+            uint64_t unknown_window(uint64_t index, uint64_t centre, int8_t& needed);
+
+            bool perform_elimination_pass();
+
+            //Groups with more unflipped tiles than this are not enumerated.
+            static const size_t MAX_GROUP_SIZE = 64;
+
+            //Groups that take more steps than this to enumerate are dropped too,
+            //a few sparse numbers can leave billions of solutions in far fewer cells.
+            static const uint64_t MAX_GROUP_WORK = 1 << 25;
+
             bool enumerate_groups();
-            std::set< std::pair< Point, float > > evaluate_group(
-                const std::set<Point> border_unflipped,
-                const std::set<Point> border_flipped
-            );
+            void evaluate_groups(std::vector<FrontierGroup>& groups);
+            void cache_groups();
+
+            uint64_t nth_interior_tile(uint64_t n);
 
             void flip_random_tile();
 
             bool flip(Point position);
             bool flag(Point position);
+            void emit(const Operation& operation);
 
-            void recursive_border_search(
-                Point position,
-                std::set<Point>& border_unflipped,
-                std::set<Point>& border_flipped
-            );
     };
+
+    typedef BasicSolver<Map> Solver;
 }
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Map.hh"
+#include "FrontierComponents.hh"
+#include "FrontierEquations.hh"
+#include "FrontierGroup.hh"
+#include "MineProbabilities.hh"
+
+namespace Casspir
+{
+    /**
+     * Scratch storage for solving, kept between solves.
+     * Containers are cleared rather than freed, so once they've grown to fit the boards being solved
+     * a solve makes no allocations. Give each solver its own, one at a time, when solving many boards.
+     */
+    class SolverContext
+    {
+        public:
+            SolverContext() {}
+
+            /**
+             * Reset for solving a new map, keeping the storage.
+             * Any board can be solved with the same context.
+             */
+            template <typename M>
+            void bind(M&)
+            {
+                this->worklist.clear();
+                this->cached_signatures.clear();
+            }
+
+        private:
+            template <typename M>
+            friend class BasicSolver;
+
+            SolverContext(const SolverContext&) = delete;
+            SolverContext& operator=(const SolverContext&) = delete;
+
+            //Frontier tiles to evaluate in the basic pass.
+            std::vector<uint64_t> worklist;
+
+            //Cells of the groups last enumerated in index order, and the chance of a mine in each.
+            std::vector<uint64_t> grouped;
+            MineProbabilities probabilities;
+
+            //The groups being enumerated, and built groups not in use whose storage is kept.
+            std::vector<FrontierGroup> groups, spare_groups;
+            FrontierGroup::Scratch group_scratch;
+
+            //Copies of the groups last enumerated, with their counts, found by signature.
+            std::vector<FrontierGroup> cached_groups;
+            std::vector< std::pair<uint64_t, size_t> > cached_signatures;
+
+            //The frontier split into the components groups are built from, and their equations.
+            FrontierComponents components;
+            FrontierEquations equations;
+
+            //Tiles found to be safe, or mines, while eliminating or enumerating.
+            std::vector<uint64_t> safe, mines;
+    };
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "casspir_config.hh"
+
+/**
+ * Statistics are only gathered when built with CASSPIR_SOLVER_STATS (./configure --enable-solver-stats),
+ * otherwise the statements given to CASSPIR_STAT compile to nothing.
+ */
+#if CASSPIR_SOLVER_STATS
+#define CASSPIR_STAT(...) __VA_ARGS__
+#else
+#define CASSPIR_STAT(...)
+#endif
+
+namespace Casspir
+{
+    struct PhaseStats {
+        uint64_t calls;
+        double seconds;
+
+        PhaseStats() : calls(0), seconds(0) {}
+    };
+
+    /**
+     * Counts and times the work done by a solver.
+     * Everything stays zero unless statistics are enabled.
+     */
+    struct SolverStats {
+        #if CASSPIR_SOLVER_STATS
+        static const bool ENABLED = true;
+        #else
+        static const bool ENABLED = false;
+        #endif
+
+        PhaseStats basic_pass;
+        PhaseStats pair_pass;
+        PhaseStats elimination_pass;
+        PhaseStats enumerate_groups;
+        PhaseStats evaluate_group;
+        PhaseStats random_flip;
+
+        //Frontier tiles evaluated by basic passes.
+        uint64_t tiles_scanned;
+
+        //Pairs of nearby frontier tiles compared by pair passes.
+        uint64_t pairs_compared;
+
+        //Tiles decided by reducing the frontier's equations.
+        uint64_t tiles_eliminated;
+
+        //Enumerated groups by number of tiles, group_sizes[size].
+        std::vector<uint64_t> group_sizes;
+
+        //Groups too big to enumerate.
+        uint64_t groups_skipped;
+
+        //Groups unchanged since the last enumeration, whose counts were reused.
+        uint64_t groups_reused;
+
+        //Partial assignments tried while enumerating, and complete ones satisfying every constraint.
+        uint64_t assignments_tried;
+        uint64_t assignments_accepted;
+
+        SolverStats() : tiles_scanned(0), pairs_compared(0), tiles_eliminated(0), groups_skipped(0), groups_reused(0), assignments_tried(0), assignments_accepted(0) {}
+    };
+
+    /**
+     * Counts a call to a phase and adds the time until it goes out of scope.
+     */
+    class PhaseTimer
+    {
+        public:
+            PhaseTimer(PhaseStats& phase) : phase(phase), start(std::chrono::steady_clock::now())
+            {
+                this->phase.calls++;
+            }
+
+            ~PhaseTimer()
+            {
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - this->start;
+                this->phase.seconds += elapsed.count();
+            }
+
+        private:
+            PhaseStats& phase;
+            std::chrono::steady_clock::time_point start;
+    };
+}
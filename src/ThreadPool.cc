@@ -0,0 +1,118 @@
+#include <algorithm>
+
+#include "ThreadPool.hh"
+
+using namespace Casspir;
+
+/**
+ * Start the worker threads.
+ * The thread calling parallel_for also runs tasks, so threads-1 workers are started.
+ *
+ * @param threads Total threads to run tasks on, 0 to match the hardware.
+ */
+ThreadPool::ThreadPool(unsigned threads)
+    : generation(0), active(0), stopping(false), task(nullptr), count(0), next(0)
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 1; i < threads; i++) {
+        this->workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+/**
+ * Stop and join the worker threads.
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+
+    for (auto& worker : this->workers) {
+        worker.join();
+    }
+}
+
+/**
+ * Get the number of threads tasks are run on, including the caller.
+ *
+ * @return threads
+ */
+unsigned ThreadPool::size()
+{
+    return this->workers.size() + 1;
+}
+
+/**
+ * Run task(0) to task(count-1) across the pool and wait for them all to finish.
+ *
+ * @param count The number of tasks.
+ * @param task The task to run for each index.
+ */
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& task)
+{
+    std::lock_guard<std::mutex> submit(this->submit_mutex);
+
+    //Not worth waking anyone.
+    if (this->workers.empty() || count <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->task = &task;
+        this->count = count;
+        this->next = 0;
+        this->active = this->workers.size();
+        this->generation++;
+    }
+    this->wake.notify_all();
+
+    this->run_tasks();
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->done.wait(lock, [this] { return this->active == 0; });
+    this->task = nullptr;
+}
+
+/**
+ * Worker loop, run the tasks of each new generation until stopped.
+ */
+void ThreadPool::work()
+{
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (true) {
+        this->wake.wait(lock, [this, seen] { return this->stopping || this->generation != seen; });
+        if (this->stopping) {
+            return;
+        }
+        seen = this->generation;
+
+        lock.unlock();
+        this->run_tasks();
+        lock.lock();
+
+        if (--this->active == 0) {
+            this->done.notify_all();
+        }
+    }
+}
+
+/**
+ * Take task indices until there are none left.
+ */
+void ThreadPool::run_tasks()
+{
+    for (size_t i = this->next++; i < this->count; i = this->next++) {
+        (*this->task)(i);
+    }
+}
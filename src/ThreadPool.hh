@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Casspir
+{
+    /**
+     * A fixed set of worker threads that run indexed tasks in parallel.
+     * Indices are handed out one at a time so uneven tasks balance themselves.
+     */
+    class ThreadPool
+    {
+        public:
+            ThreadPool(unsigned threads = 0);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            unsigned size();
+            void parallel_for(size_t count, const std::function<void(size_t)>& task);
+
+        private:
+            std::vector<std::thread> workers;
+
+            //Held by parallel_for so only one caller uses the workers at a time.
+            std::mutex submit_mutex;
+
+            std::mutex mutex;
+            std::condition_variable wake, done;
+            uint64_t generation;
+            unsigned active;
+            bool stopping;
+
+            const std::function<void(size_t)>* task;
+            size_t count;
+            std::atomic<size_t> next;
+
+            void work();
+            void run_tasks();
+    };
+}
@@ -0,0 +1,240 @@
+#include <cassert>
+#include <cstring>
+
+#include "TileValues.hh"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CASSPIR_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+using namespace Casspir;
+
+namespace
+{
+    //Rows are padded by a tile either side, plus room for the widest kernel to read past the end.
+    const uint32_t PADDING = 64;
+
+    typedef void (*RowKernel)(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* out, uint32_t width);
+
+    /**
+     * The 8 bits of a byte spread into 8 bytes of 0 or 1.
+     */
+    struct ByteTable {
+        uint8_t bytes[256][8];
+
+        ByteTable()
+        {
+            for (unsigned value = 0; value < 256; value++) {
+                for (unsigned bit = 0; bit < 8; bit++) {
+                    this->bytes[value][bit] = (value >> bit) & 1;
+                }
+            }
+        }
+    };
+
+    const ByteTable& byte_table()
+    {
+        static const ByteTable table;
+        return table;
+    }
+
+    /**
+     * Read 64 bits from the plane starting at any bit offset.
+     */
+    uint64_t extract_bits(const Bitplane& plane, uint64_t offset)
+    {
+        uint64_t word = offset >> 6;
+        unsigned shift = offset & 63;
+
+        uint64_t bits = plane.word(word) >> shift;
+        if (shift != 0 && word + 1 < plane.num_words()) {
+            bits |= plane.word(word + 1) << (64 - shift);
+        }
+        return bits;
+    }
+
+    /**
+     * Expand a row of mines into bytes, tile x goes to row[x + 1].
+     */
+    void expand_row(const Bitplane& mines, uint64_t offset, uint32_t width, uint8_t* row)
+    {
+        const ByteTable& table = byte_table();
+
+        for (uint32_t x = 0; x < width; x += 64) {
+            uint64_t bits = extract_bits(mines, offset + x);
+            uint32_t remaining = width - x;
+            if (remaining < 64) {
+                //Don't let the next row's mines in.
+                bits &= (1ULL << remaining) - 1;
+            }
+
+            for (unsigned byte = 0; byte < 8; byte++) {
+                std::memcpy(row + 1 + x + byte * 8, table.bytes[(bits >> (byte * 8)) & 0xFF], 8);
+            }
+        }
+    }
+
+    void sum_rows_scalar(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* out, uint32_t width)
+    {
+        for (uint32_t x = 0; x < width; x++) {
+            out[x] = above[x] + above[x + 1] + above[x + 2]
+                + row[x] + row[x + 2]
+                + below[x] + below[x + 1] + below[x + 2];
+        }
+    }
+
+#ifdef CASSPIR_X86_KERNELS
+    __attribute__((target("sse2")))
+    void sum_rows_sse2(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* out, uint32_t width)
+    {
+        for (uint32_t x = 0; x < width; x += 16) {
+            //Column sums at x-1, x and x+1, the centre column less the tile itself.
+            __m128i left = _mm_add_epi8(
+                _mm_add_epi8(_mm_loadu_si128((const __m128i*)(above + x)), _mm_loadu_si128((const __m128i*)(row + x))),
+                _mm_loadu_si128((const __m128i*)(below + x))
+            );
+            __m128i centre = _mm_add_epi8(_mm_loadu_si128((const __m128i*)(above + x + 1)), _mm_loadu_si128((const __m128i*)(below + x + 1)));
+            __m128i right = _mm_add_epi8(
+                _mm_add_epi8(_mm_loadu_si128((const __m128i*)(above + x + 2)), _mm_loadu_si128((const __m128i*)(row + x + 2))),
+                _mm_loadu_si128((const __m128i*)(below + x + 2))
+            );
+
+            _mm_storeu_si128((__m128i*)(out + x), _mm_add_epi8(_mm_add_epi8(left, centre), right));
+        }
+    }
+
+    __attribute__((target("avx2")))
+    void sum_rows_avx2(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* out, uint32_t width)
+    {
+        for (uint32_t x = 0; x < width; x += 32) {
+            __m256i left = _mm256_add_epi8(
+                _mm256_add_epi8(_mm256_loadu_si256((const __m256i*)(above + x)), _mm256_loadu_si256((const __m256i*)(row + x))),
+                _mm256_loadu_si256((const __m256i*)(below + x))
+            );
+            __m256i centre = _mm256_add_epi8(_mm256_loadu_si256((const __m256i*)(above + x + 1)), _mm256_loadu_si256((const __m256i*)(below + x + 1)));
+            __m256i right = _mm256_add_epi8(
+                _mm256_add_epi8(_mm256_loadu_si256((const __m256i*)(above + x + 2)), _mm256_loadu_si256((const __m256i*)(row + x + 2))),
+                _mm256_loadu_si256((const __m256i*)(below + x + 2))
+            );
+
+            _mm256_storeu_si256((__m256i*)(out + x), _mm256_add_epi8(_mm256_add_epi8(left, centre), right));
+        }
+    }
+#endif
+
+    RowKernel select_kernel(TileValues::Kernel kernel)
+    {
+#ifdef CASSPIR_X86_KERNELS
+        if (kernel == TileValues::Kernel::AUTO) {
+            if (TileValues::is_supported(TileValues::Kernel::AVX2)) {
+                return sum_rows_avx2;
+            }
+            if (TileValues::is_supported(TileValues::Kernel::SSE2)) {
+                return sum_rows_sse2;
+            }
+        } else if (kernel == TileValues::Kernel::AVX2) {
+            return sum_rows_avx2;
+        } else if (kernel == TileValues::Kernel::SSE2) {
+            return sum_rows_sse2;
+        }
+#endif
+        return sum_rows_scalar;
+    }
+
+    /**
+     * Pack a row of values into nibbles, the row starts at tile index.
+     */
+    void pack_row(const uint8_t* out, uint64_t index, uint32_t width, std::vector<uint8_t>& values)
+    {
+        uint32_t x = 0;
+
+        //An odd start shares it's byte with the end of the last row.
+        if (index & 1) {
+            values[index >> 1] |= out[0] << 4;
+            x++;
+            index++;
+        }
+
+        for (; x + 1 < width; x += 2, index += 2) {
+            values[index >> 1] = out[x] | (out[x + 1] << 4);
+        }
+
+        if (x < width) {
+            values[index >> 1] = out[x];
+        }
+    }
+}
+
+/**
+ * Check whether a kernel can run on this CPU.
+ *
+ * @param kernel
+ *
+ * @return Whether the kernel is usable, AUTO and SCALAR always are.
+ */
+bool TileValues::is_supported(Kernel kernel)
+{
+    switch (kernel) {
+#ifdef CASSPIR_X86_KERNELS
+        case Kernel::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case Kernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+#else
+        case Kernel::SSE2:
+        case Kernel::AVX2:
+            return false;
+#endif
+        default:
+            return true;
+    }
+}
+
+/**
+ * Compute every tile's value from the mines, overwriting values.
+ *
+ * @param mines The mines, width*height bits in index order.
+ * @param width
+ * @param height
+ * @param values A nibble per tile, (width*height+1)/2 bytes.
+ * @param kernel The kernel to use, AUTO picks the widest the CPU supports.
+ */
+void TileValues::compute(
+    const Bitplane& mines,
+    uint32_t width,
+    uint32_t height,
+    std::vector<uint8_t>& values,
+    Kernel kernel
+) {
+    uint64_t size = static_cast<uint64_t>(width) * height;
+    assert (mines.size() == size && values.size() == (size + 1) / 2);
+    assert (is_supported(kernel));
+
+    if (size == 0) {
+        return;
+    }
+
+    RowKernel sum_rows = select_kernel(kernel);
+
+    //Three rolling rows of mines, a row of zeros for beyond the edges, and the output row.
+    uint64_t stride = ((static_cast<uint64_t>(width) + 63) & ~63ULL) + PADDING;
+    std::vector<uint8_t> buffer(stride * 5, 0);
+    uint8_t* rows[3] = {&buffer[0], &buffer[stride], &buffer[stride * 2]};
+    const uint8_t* zeros = &buffer[stride * 3];
+    uint8_t* out = &buffer[stride * 4];
+
+    expand_row(mines, 0, width, rows[0]);
+
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t* above = y > 0 ? rows[(y - 1) % 3] : zeros;
+        const uint8_t* below = zeros;
+        if (y + 1 < height) {
+            expand_row(mines, static_cast<uint64_t>(y + 1) * width, width, rows[(y + 1) % 3]);
+            below = rows[(y + 1) % 3];
+        }
+
+        sum_rows(above, rows[y % 3], below, out, width);
+        pack_row(out, static_cast<uint64_t>(y) * width, width, values);
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Bitplane.hh"
+
+namespace Casspir
+{
+    /**
+     * Computes every tile's value, the number of neighbouring mines, from a mine bitplane at once.
+     * Each row of mines is expanded to bytes and the counts are a 3x3 box sum over three rows,
+     * less the tile itself, done 16 or 32 tiles at a time where the CPU supports it.
+     */
+    namespace TileValues
+    {
+        enum class Kernel {
+            AUTO,
+            SCALAR,
+            SSE2,
+            AVX2
+        };
+
+        bool is_supported(Kernel kernel);
+
+        void compute(
+            const Bitplane& mines,
+            uint32_t width,
+            uint32_t height,
+            std::vector<uint8_t>& values,
+            Kernel kernel = Kernel::AUTO
+        );
+    }
+}
@@ -1,3 +1,10 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <random>
+
 #include "casspir.hh"
 #include "Solver.hh"
 
@@ -16,6 +23,39 @@ Casspir::Map casspir_generate_map(uint32_t w, uint32_t h, uint8_t difficulty, Ca
     return Casspir::Map(w, h, difficulty, click);
 }
 
+/**
+ * Generate a w*h minesweeper map with exactly num_mines mines,
+ * the same seed always gives the same map.
+ *
+ * @param w Width
+ * @param h Height
+ * @param num_mines Number of mines, limited to the tiles outside the click's neighbourhood.
+ * @param click Coordinate of the players first move.
+ * @param seed Seed for the mine placements.
+ *
+ * @return A new minesweeper map
+ */
+Casspir::Map casspir_generate_seeded_map(uint32_t w, uint32_t h, uint64_t num_mines, Casspir::Point click, uint64_t seed)
+{
+    Casspir::Map map(w, h, std::set<Casspir::Point>());
+    map.generate_seeded(num_mines, click, seed);
+    return map;
+}
+
+/**
+ * Get the number of mines giving a w*h map the given density.
+ *
+ * @param w Width
+ * @param h Height
+ * @param density Fraction of tiles that are mines, 0 to 1.
+ *
+ * @return Number of mines
+ */
+uint64_t casspir_mines_for_density(uint32_t w, uint32_t h, double density)
+{
+    return static_cast<uint64_t>(std::llround(density * w * h));
+}
+
 /**
  * Make a w*h minesweeper map with the mines in the given positions.
  *
@@ -30,6 +70,100 @@ Casspir::Map casspir_make_map(uint32_t w, uint32_t h, std::set<Casspir::Point> m
     return Casspir::Map(w, h, mines);
 }
 
+/**
+ * Generate count w*h minesweeper maps that can be solved within options.max_guesses guesses.
+ * Boards are generated and solved in parallel, each thread reusing it's own random engine and map.
+ *
+ * @param w Width
+ * @param h Height
+ * @param difficulty Difficulty factor 0-255
+ * @param click Coordinate of the players first move.
+ * @param count The number of maps wanted.
+ * @param options Acceptance criteria and threading.
+ *
+ * @return The accepted maps and throughput.
+ */
+Casspir::BatchResult casspir_generate_batch(
+    uint32_t w,
+    uint32_t h,
+    uint8_t difficulty,
+    Casspir::Point click,
+    uint64_t count,
+    Casspir::BatchOptions options
+) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::unique_ptr<Casspir::ThreadPool> own_pool;
+    Casspir::ThreadPool* thread_pool = options.thread_pool;
+    if (thread_pool == nullptr) {
+        own_pool.reset(new Casspir::ThreadPool());
+        thread_pool = own_pool.get();
+    }
+
+    Casspir::BatchResult result;
+    result.maps.reserve(count);
+    std::mutex result_mutex;
+    std::atomic<uint64_t> accepted(0);
+    std::atomic<uint64_t> attempts(0);
+
+    std::random_device r_device;
+    std::vector<uint32_t> seeds;
+    for (unsigned i = 0; i < thread_pool->size(); i++) {
+        seeds.push_back(r_device());
+    }
+
+    //Only the outcome matters, not the moves.
+    Casspir::OperationSink ignore_operations = [](const Casspir::Operation&) {};
+
+    //One long running task per thread.
+    thread_pool->parallel_for(thread_pool->size(), [&](size_t thread) {
+        std::default_random_engine r_engine(seeds[thread]);
+        Casspir::Map map(w, h, difficulty, click, r_engine);
+        Casspir::SolverContext context;
+
+        while (accepted < count) {
+            uint64_t attempt = attempts++;
+            if (options.max_attempts > 0 && attempt >= options.max_attempts) {
+                break;
+            }
+
+            //Boards the first flip completes aren't puzzles.
+            bool trivial = map.get_status() == Casspir::MapStatus::COMPLETE;
+
+            Casspir::Solver solver(map, context);
+            solver.set_guess_limit(options.max_guesses);
+            solver.solve(ignore_operations);
+
+            if (!trivial
+            && map.get_status() == Casspir::MapStatus::COMPLETE
+            && solver.get_guesses() <= options.max_guesses
+            ) {
+                //Put the board back how it was generated.
+                map.reset();
+                map.flip(click);
+
+                std::lock_guard<std::mutex> lock(result_mutex);
+                if (result.maps.size() < count) {
+                    result.maps.push_back(map);
+                    accepted++;
+                }
+            }
+
+            map.generate(difficulty, click, r_engine);
+        }
+    });
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.attempts = attempts;
+    if (options.max_attempts > 0) {
+        result.attempts = std::min(result.attempts, options.max_attempts);
+    }
+    result.seconds = elapsed.count();
+    result.boards_per_second = result.maps.size() / result.seconds;
+
+    return result;
+}
+
 /**
  * Solve the given map.
  *
@@ -43,7 +177,83 @@ std::queue<Casspir::Operation> casspir_solve(Casspir::Map& map)
     return solver.solve();
 }
 
+/**
+ * Solve the given map, evaluating independent groups in parallel.
+ * The operations are the same as solving without a thread pool.
+ *
+ * @param map The game map to solve.
+ * @param thread_pool The threads to use.
+ *
+ * @return A list of tile operations in sequence.
+ */
+std::queue<Casspir::Operation> casspir_solve(Casspir::Map& map, Casspir::ThreadPool& thread_pool)
+{
+    Casspir::Solver solver(map, &thread_pool);
+    return solver.solve();
+}
+
+/**
+ * Solve the given map, streaming each operation to the sink as it's made.
+ *
+ * @param map The game map to solve.
+ * @param sink Called with each tile operation in sequence.
+ */
+void casspir_solve(Casspir::Map& map, const Casspir::OperationSink& sink)
+{
+    Casspir::Solver solver(map);
+    solver.solve(sink);
+}
+
+/**
+ * Solve the given map, evaluating independent groups in parallel
+ * and streaming each operation to the sink as it's made.
+ * The sink is only called from the calling thread.
+ *
+ * @param map The game map to solve.
+ * @param thread_pool The threads to use.
+ * @param sink Called with each tile operation in sequence.
+ */
+void casspir_solve(Casspir::Map& map, Casspir::ThreadPool& thread_pool, const Casspir::OperationSink& sink)
+{
+    Casspir::Solver solver(map, &thread_pool);
+    solver.solve(sink);
+}
+
+/**
+ * Solve the given map, streaming each operation to the sink as it's made,
+ * and report the work the solver did.
+ * The stats are only filled in when built with solver statistics enabled.
+ *
+ * @param map The game map to solve.
+ * @param sink Called with each tile operation in sequence.
+ * @param stats Set to the solver's counts and times.
+ */
+void casspir_solve(Casspir::Map& map, const Casspir::OperationSink& sink, Casspir::SolverStats& stats)
+{
+    Casspir::Solver solver(map);
+    solver.solve(sink);
+    stats = solver.get_stats();
+}
+
+/**
+ * Solve the given map, streaming each operation to the sink as it's made,
+ * with scratch storage kept from earlier solves.
+ * Reusing a context across many boards avoids allocating while solving.
+ *
+ * @param map The game map to solve.
+ * @param context Scratch storage, used by one solve at a time.
+ * @param sink Called with each tile operation in sequence.
+ */
+void casspir_solve(Casspir::Map& map, Casspir::SolverContext& context, const Casspir::OperationSink& sink)
+{
+    Casspir::Solver solver(map, context);
+    solver.solve(sink);
+}
+
 /**
  * I found this stub neccessary to satisfy an AC_CHECK_LIB macro in autotools.
  */
-extern "C" int casspir_c_stub() {}
\ No newline at end of file
+extern "C" int casspir_c_stub()
+{
+    return 0;
+}
\ No newline at end of file
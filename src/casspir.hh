@@ -2,10 +2,43 @@
 
 #include <set>
 #include <queue>
+#include <vector>
 #include <cstdint>
 
 #include "definitions.hh"
 #include "Map.hh"
+#include "ThreadPool.hh"
+#include "SolverStats.hh"
+#include "SolverContext.hh"
+
+namespace Casspir
+{
+    struct BatchOptions {
+        //Boards needing more guesses than this are rejected, 0 for no-guess boards.
+        uint64_t max_guesses;
+
+        //Give up after generating this many boards, 0 to keep going until count are found.
+        uint64_t max_attempts;
+
+        //Threads to generate on, a pool sized to the hardware is made if null.
+        ThreadPool* thread_pool;
+
+        BatchOptions(
+            uint64_t max_guesses = 0,
+            uint64_t max_attempts = 0,
+            ThreadPool* thread_pool = nullptr
+        ) : max_guesses(max_guesses), max_attempts(max_attempts), thread_pool(thread_pool)
+        {}
+    };
+
+    struct BatchResult {
+        //Accepted boards, with only the first flip made.
+        std::vector<Map> maps;
+        uint64_t attempts;
+        double seconds;
+        double boards_per_second;
+    };
+}
 
 Casspir::Map casspir_generate_map(
     uint32_t w,
@@ -14,12 +47,40 @@ Casspir::Map casspir_generate_map(
     Casspir::Point click
 );
 
+Casspir::Map casspir_generate_seeded_map(
+    uint32_t w,
+    uint32_t h,
+    uint64_t num_mines,
+    Casspir::Point click,
+    uint64_t seed
+);
+
+uint64_t casspir_mines_for_density(
+    uint32_t w,
+    uint32_t h,
+    double density
+);
+
 Casspir::Map casspir_make_map(
     uint32_t w,
     uint32_t h,
     std::set<Casspir::Point> mines
 );
 
+Casspir::BatchResult casspir_generate_batch(
+    uint32_t w,
+    uint32_t h,
+    uint8_t difficulty,
+    Casspir::Point click,
+    uint64_t count,
+    Casspir::BatchOptions options = Casspir::BatchOptions()
+);
+
 std::queue<Casspir::Operation> casspir_solve(Casspir::Map& map);
+std::queue<Casspir::Operation> casspir_solve(Casspir::Map& map, Casspir::ThreadPool& thread_pool);
+void casspir_solve(Casspir::Map& map, const Casspir::OperationSink& sink);
+void casspir_solve(Casspir::Map& map, Casspir::ThreadPool& thread_pool, const Casspir::OperationSink& sink);
+void casspir_solve(Casspir::Map& map, const Casspir::OperationSink& sink, Casspir::SolverStats& stats);
+void casspir_solve(Casspir::Map& map, Casspir::SolverContext& context, const Casspir::OperationSink& sink);
 
 extern "C" int casspir_c_stub();
\ No newline at end of file
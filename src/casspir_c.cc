@@ -0,0 +1,361 @@
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "casspir_c.h"
+#include "Map.hh"
+#include "Solver.hh"
+
+/**
+ * Nothing may be thrown across the C interface, entry points that can fail
+ * catch everything and return NULL or 0, including when out of memory.
+ */
+struct casspir_map {
+    Casspir::Map map;
+
+    //The map is built in place, rather than built and then copied.
+    template<typename... Args>
+    casspir_map(Args&&... args) : map(std::forward<Args>(args)...) {}
+};
+
+struct casspir_solver {
+    Casspir::Solver solver;
+    uint32_t width;
+    bool solved;
+
+    //Operations that didn't fit in the caller's buffer, handed out by later calls.
+    std::vector<uint64_t> pending;
+    size_t next;
+
+    casspir_solver(Casspir::Map& map) : solver(map), width(map.get_width()), solved(false), next(0) {}
+};
+
+/**
+ * Whether a map of the given size may be made.
+ *
+ * @param width
+ * @param height
+ *
+ * @return false if the map is empty or has more than CASSPIR_MAX_TILES tiles.
+ */
+static bool is_allowed_size(uint32_t width, uint32_t height)
+{
+    uint64_t tiles = static_cast<uint64_t>(width) * height;
+    return tiles > 0 && tiles <= CASSPIR_MAX_TILES;
+}
+
+/**
+ * Generate a map with exactly num_mines mines and make the first flip.
+ *
+ * @param width Width
+ * @param height Height
+ * @param num_mines Number of mines, limited to the tiles outside the click's neighbourhood.
+ * @param click_x Coordinate of the players first move.
+ * @param click_y
+ * @param seed Seed for the mine placements, the same seed always gives the same map.
+ *
+ * @return A new map, or NULL.
+ */
+casspir_map* casspir_map_generate(uint32_t width, uint32_t height, uint64_t num_mines, uint32_t click_x, uint32_t click_y, uint64_t seed)
+{
+    if (!is_allowed_size(width, height) || click_x >= width || click_y >= height) {
+        return nullptr;
+    }
+
+    casspir_map* map = nullptr;
+    try {
+        map = new casspir_map(width, height, std::set<Casspir::Point>());
+        map->map.generate_seeded(num_mines, Casspir::Point(click_x, click_y), seed);
+        return map;
+    } catch (...) {
+        delete map;
+        return nullptr;
+    }
+}
+
+/**
+ * Make a map from a mine bitmap, no tiles are flipped.
+ *
+ * @param width Width
+ * @param height Height
+ * @param mines One bit per tile in index order, packed into (width*height+63)/64 words.
+ *
+ * @return A new map, or NULL.
+ */
+casspir_map* casspir_map_from_mines(uint32_t width, uint32_t height, const uint64_t* mines)
+{
+    if (!is_allowed_size(width, height) || mines == nullptr) {
+        return nullptr;
+    }
+
+    try {
+        return new casspir_map(width, height, mines);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+/**
+ * Copy a map in it's current state.
+ *
+ * @param map
+ *
+ * @return A new map, or NULL.
+ */
+casspir_map* casspir_map_copy(const casspir_map* map)
+{
+    try {
+        return new casspir_map(map->map);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+/**
+ * Free a map, any solver made for it must be freed first.
+ *
+ * @param map The map, or NULL.
+ */
+void casspir_map_free(casspir_map* map)
+{
+    delete map;
+}
+
+uint32_t casspir_map_width(casspir_map* map)
+{
+    return map->map.get_width();
+}
+
+uint32_t casspir_map_height(casspir_map* map)
+{
+    return map->map.get_height();
+}
+
+/**
+ * Get the status of the game.
+ *
+ * @param map
+ *
+ * @return CASSPIR_IN_PROGRESS, CASSPIR_FAILED or CASSPIR_COMPLETE
+ */
+int casspir_map_status(casspir_map* map)
+{
+    switch (map->map.get_status()) {
+        case Casspir::MapStatus::FAILED:
+            return CASSPIR_FAILED;
+        case Casspir::MapStatus::COMPLETE:
+            return CASSPIR_COMPLETE;
+        default:
+            return CASSPIR_IN_PROGRESS;
+    }
+}
+
+uint64_t casspir_map_num_flipped(casspir_map* map)
+{
+    return map->map.get_num_flipped();
+}
+
+uint64_t casspir_map_mines_remaining(casspir_map* map)
+{
+    return map->map.get_mines_remaining();
+}
+
+/**
+ * Flip a tile, see Map::flip.
+ *
+ * @param map
+ * @param x
+ * @param y
+ *
+ * @return The number of tiles flipped, 0 if the position is off the map or the flip failed.
+ */
+uint64_t casspir_map_flip(casspir_map* map, uint32_t x, uint32_t y)
+{
+    if (x >= map->map.get_width() || y >= map->map.get_height()) {
+        return 0;
+    }
+
+    try {
+        return map->map.flip(Casspir::Point(x, y));
+    } catch (...) {
+        return 0;
+    }
+}
+
+/**
+ * Toggle a flag on a tile, positions off the map are ignored.
+ *
+ * @param map
+ * @param x
+ * @param y
+ */
+void casspir_map_flag(casspir_map* map, uint32_t x, uint32_t y)
+{
+    if (x >= map->map.get_width() || y >= map->map.get_height()) {
+        return;
+    }
+
+    try {
+        map->map.flag(Casspir::Point(x, y));
+    } catch (...) {
+    }
+}
+
+/**
+ * Undo every flip and flag, including the first flip.
+ *
+ * @param map
+ */
+void casspir_map_reset(casspir_map* map)
+{
+    try {
+        map->map.reset();
+    } catch (...) {
+    }
+}
+
+/**
+ * Copy the state of every tile, in index order, into the caller's buffer.
+ *
+ * @param map
+ * @param tiles Buffer for the tiles.
+ * @param capacity Tiles the buffer holds, only this many are written.
+ *
+ * @return The number of tiles on the map.
+ */
+uint64_t casspir_map_read_tiles(casspir_map* map, casspir_tile* tiles, uint64_t capacity)
+{
+    Casspir::Map& m = map->map;
+    uint64_t size = m.get_size();
+    uint64_t count = capacity < size ? capacity : size;
+
+    for (uint64_t i = 0; i < count; i++) {
+        tiles[i].value = m.get_value(i);
+        tiles[i].mine = m.is_mine(i);
+        tiles[i].flagged = m.is_flagged(i);
+        tiles[i].flipped = m.is_flipped(i);
+    }
+
+    return size;
+}
+
+/**
+ * Make a solver for a map.
+ *
+ * @param map The map to play on, it must outlive the solver.
+ *
+ * @return A new solver, or NULL.
+ */
+casspir_solver* casspir_solver_new(casspir_map* map)
+{
+    try {
+        return new casspir_solver(map->map);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+/**
+ * Free a solver.
+ *
+ * @param solver The solver, or NULL.
+ */
+void casspir_solver_free(casspir_solver* solver)
+{
+    delete solver;
+}
+
+/**
+ * Stop solving once more than this many guesses have been made.
+ *
+ * @param solver
+ * @param guess_limit
+ */
+void casspir_solver_set_guess_limit(casspir_solver* solver, uint64_t guess_limit)
+{
+    solver->solver.set_guess_limit(guess_limit);
+}
+
+/**
+ * Get the number of flips made without certainty that the tile was safe.
+ *
+ * @param solver
+ *
+ * @return guesses
+ */
+uint64_t casspir_solver_guesses(casspir_solver* solver)
+{
+    return solver->solver.get_guesses();
+}
+
+/**
+ * Solve the map, writing the operations into the caller's buffer.
+ * The first call plays the whole game, operations that don't fit are kept
+ * and returned by the following calls, so call until it returns less than capacity.
+ *
+ * @param solver
+ * @param operations Buffer for the operations, see CASSPIR_OPERATION_INDEX.
+ * @param capacity Operations the buffer holds.
+ *
+ * @return The number of operations written, if solving fails part way only those made so far are returned.
+ */
+uint64_t casspir_solver_solve(casspir_solver* solver, uint64_t* operations, uint64_t capacity)
+{
+    uint64_t written = 0;
+
+    if (!solver->solved) {
+        solver->solved = true;
+        uint32_t width = solver->width;
+        try {
+            solver->solver.solve([solver, operations, capacity, width, &written](const Casspir::Operation& operation) {
+                if (written < capacity) {
+                    operations[written++] = operation.encode(width);
+                } else {
+                    solver->pending.push_back(operation.encode(width));
+                }
+            });
+        } catch (...) {
+        }
+        return written;
+    }
+
+    while (written < capacity && solver->next < solver->pending.size()) {
+        operations[written++] = solver->pending[solver->next++];
+    }
+    return written;
+}
+
+/**
+ * Flip a tile on each of many maps.
+ *
+ * @param maps
+ * @param xs The position to flip on each map.
+ * @param ys
+ * @param flipped Set to the number of tiles flipped on each map, may be NULL.
+ * @param count Number of maps.
+ */
+void casspir_maps_flip(casspir_map** maps, const uint32_t* xs, const uint32_t* ys, uint64_t* flipped, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        uint64_t tiles = casspir_map_flip(maps[i], xs[i], ys[i]);
+        if (flipped != nullptr) {
+            flipped[i] = tiles;
+        }
+    }
+}
+
+/**
+ * Solve many maps, see casspir_solver_solve.
+ *
+ * @param solvers
+ * @param count Number of solvers.
+ * @param operations Buffer of count*capacity operations, solver i writes from operations + i*capacity.
+ * @param capacity Operations each solver may write.
+ * @param num_operations Set to the number of operations each solver wrote.
+ */
+void casspir_solvers_solve(casspir_solver** solvers, size_t count, uint64_t* operations, uint64_t capacity, uint64_t* num_operations)
+{
+    for (size_t i = 0; i < count; i++) {
+        num_operations[i] = casspir_solver_solve(solvers[i], operations + i * capacity, capacity);
+    }
+}
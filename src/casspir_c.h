@@ -0,0 +1,70 @@
+#pragma once
+
+/**
+ * C interface to Casspir.
+ * Maps and solvers are opaque handles, and results are written into buffers owned by the caller.
+ * Nothing is thrown across it, calls that fail, even for lack of memory, return NULL or 0.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct casspir_map casspir_map;
+typedef struct casspir_solver casspir_solver;
+
+/* Values of casspir_map_status. */
+#define CASSPIR_IN_PROGRESS 0
+#define CASSPIR_FAILED 1
+#define CASSPIR_COMPLETE 2
+
+/* Operations are the tile index shifted up one bit, with the low bit set for a flag. */
+#define CASSPIR_OPERATION_INDEX(operation) ((operation) >> 1)
+#define CASSPIR_OPERATION_IS_FLAG(operation) ((operation) & 1)
+
+typedef struct {
+    uint8_t value;
+    uint8_t mine;
+    uint8_t flagged;
+    uint8_t flipped;
+} casspir_tile;
+
+/* Maps with more tiles than this aren't made, so a bad size can't exhaust memory. */
+#define CASSPIR_MAX_TILES ((uint64_t)1 << 28)
+
+/* Maps, NULL is returned if the map couldn't be made, or is empty or over CASSPIR_MAX_TILES. */
+casspir_map* casspir_map_generate(uint32_t width, uint32_t height, uint64_t num_mines, uint32_t click_x, uint32_t click_y, uint64_t seed);
+casspir_map* casspir_map_from_mines(uint32_t width, uint32_t height, const uint64_t* mines);
+casspir_map* casspir_map_copy(const casspir_map* map);
+void casspir_map_free(casspir_map* map);
+
+uint32_t casspir_map_width(casspir_map* map);
+uint32_t casspir_map_height(casspir_map* map);
+int casspir_map_status(casspir_map* map);
+uint64_t casspir_map_num_flipped(casspir_map* map);
+uint64_t casspir_map_mines_remaining(casspir_map* map);
+
+uint64_t casspir_map_flip(casspir_map* map, uint32_t x, uint32_t y);
+void casspir_map_flag(casspir_map* map, uint32_t x, uint32_t y);
+void casspir_map_reset(casspir_map* map);
+uint64_t casspir_map_read_tiles(casspir_map* map, casspir_tile* tiles, uint64_t capacity);
+
+/* Solvers play on the map they're made for, which must outlive them. */
+casspir_solver* casspir_solver_new(casspir_map* map);
+void casspir_solver_free(casspir_solver* solver);
+void casspir_solver_set_guess_limit(casspir_solver* solver, uint64_t guess_limit);
+uint64_t casspir_solver_guesses(casspir_solver* solver);
+uint64_t casspir_solver_solve(casspir_solver* solver, uint64_t* operations, uint64_t capacity);
+
+/* Batches, element i of each array belongs to handle i. */
+void casspir_maps_flip(casspir_map** maps, const uint32_t* xs, const uint32_t* ys, uint64_t* flipped, size_t count);
+void casspir_solvers_solve(casspir_solver** solvers, size_t count, uint64_t* operations, uint64_t capacity, uint64_t* num_operations);
+
+int casspir_c_stub();
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
+#include <functional>
 
 namespace Casspir
 {
@@ -57,6 +59,37 @@ namespace Casspir
         }
     };
 
+    /**
+     * A fixed capacity list of neighbouring tile indices.
+     * Stored inline so that iterating over neighbours never allocates.
+     */
+    struct Neighbours {
+        uint64_t indices[8];
+        uint8_t count;
+
+        Neighbours() : count(0) {};
+
+        void push(uint64_t index)
+        {
+            this->indices[this->count++] = index;
+        }
+
+        size_t size() const
+        {
+            return this->count;
+        }
+
+        const uint64_t* begin() const
+        {
+            return this->indices;
+        }
+
+        const uint64_t* end() const
+        {
+            return this->indices + this->count;
+        }
+    };
+
     enum OperationType {
         FLIP,
         FLAG
@@ -71,8 +104,27 @@ namespace Casspir
             Point position
         ) : type(type), position(position)
         {}
+
+        /**
+         * Pack into a single word, the tile index shifted up with the type in the low bit.
+         */
+        uint64_t encode(uint32_t width) const
+        {
+            return (this->position.get_index(width) << 1) | (this->type == OperationType::FLAG);
+        }
+
+        static Operation decode(uint64_t encoded, uint32_t width)
+        {
+            return Operation(
+                (encoded & 1) ? OperationType::FLAG : OperationType::FLIP,
+                Point::from_index(encoded >> 1, width)
+            );
+        }
     };
 
+    //Receives each operation as it's made.
+    typedef std::function<void(const Operation&)> OperationSink;
+
     enum MapStatus {
         IN_PROGRESS,
         FAILED,
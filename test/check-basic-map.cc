@@ -0,0 +1,190 @@
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <casspir.hh>
+#include <BasicMap.hh>
+#include <Solver.hh>
+
+//Every allocation in the program is counted.
+static uint64_t allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    allocations++;
+    void* pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+/**
+ * Check a fixed board matches a dynamic one tile for tile.
+ */
+template <uint32_t W, uint32_t H>
+static void assert_same(const Casspir::BasicMap<W, H>& fixed, Casspir::Map& map)
+{
+    assert( fixed.get_status() == map.get_status() );
+    assert( fixed.get_num_flipped() == map.get_num_flipped() );
+    assert( fixed.get_mines_remaining() == map.get_mines_remaining() );
+    assert( fixed.get_total_mines() == map.get_total_mines() );
+    for (uint64_t i = 0; i < fixed.get_size(); i++) {
+        Casspir::TileState a = fixed.get_tile(i);
+        Casspir::TileState b = map.get_tile(i);
+        assert( a.value == b.value && a.mine == b.mine && a.flagged == b.flagged && a.flipped == b.flipped );
+        assert( fixed.is_frontier(i) == map.is_frontier(i) );
+    }
+}
+
+/**
+ * The same seed gives the same board, and the same moves play out the same way.
+ */
+template <uint32_t W, uint32_t H>
+static void test_plays_like_map(uint64_t num_mines)
+{
+    std::default_random_engine r_engine(W * H);
+    std::uniform_int_distribution<uint32_t> x_distribution(0, W - 1), y_distribution(0, H - 1);
+
+    for (uint64_t seed = 0; seed < 50; seed++) {
+        Casspir::Point click(x_distribution(r_engine), y_distribution(r_engine));
+        Casspir::BasicMap<W, H> fixed;
+        fixed.generate_seeded(num_mines, click, seed);
+        Casspir::Map map = casspir_generate_seeded_map(W, H, num_mines, click, seed);
+        assert_same(fixed, map);
+
+        //Random flags and flips, including flipping flipped tiles to expand them, until the game ends.
+        while (map.get_status() == Casspir::MapStatus::IN_PROGRESS) {
+            Casspir::Point position(x_distribution(r_engine), y_distribution(r_engine));
+            if (r_engine() % 4 == 0) {
+                fixed.flag(position);
+                map.flag(position);
+            } else {
+                assert( fixed.flip(position) == map.flip(position) );
+            }
+            assert_same(fixed, map);
+        }
+    }
+}
+
+/**
+ * Solving a fixed board makes the same moves as solving the same board in a Map.
+ */
+template <uint32_t W, uint32_t H>
+static void test_solves_like_map(uint64_t num_mines)
+{
+    std::vector<uint64_t> fixed_operations, operations;
+    Casspir::OperationSink fixed_sink = [&fixed_operations](const Casspir::Operation& operation) {
+        fixed_operations.push_back(operation.encode(W));
+    };
+    Casspir::OperationSink sink = [&operations](const Casspir::Operation& operation) {
+        operations.push_back(operation.encode(W));
+    };
+
+    for (uint64_t seed = 0; seed < 20; seed++) {
+        Casspir::Point click(W/2, H/2);
+        Casspir::BasicMap<W, H> fixed;
+        fixed.generate_seeded(num_mines, click, seed);
+        Casspir::Map map = casspir_generate_seeded_map(W, H, num_mines, click, seed);
+
+        fixed_operations.clear();
+        Casspir::BasicSolver< Casspir::BasicMap<W, H> > fixed_solver(fixed);
+        fixed_solver.solve(fixed_sink);
+
+        operations.clear();
+        Casspir::Solver solver(map);
+        solver.solve(sink);
+
+        assert( fixed_operations == operations );
+        assert( fixed_solver.get_guesses() == solver.get_guesses() );
+        assert_same(fixed, map);
+    }
+}
+
+/**
+ * A board loaded from it's mines matches the board they came from.
+ */
+static void test_from_mines()
+{
+    Casspir::ExpertMap generated;
+    generated.generate_seeded(99, Casspir::Point(15, 8), 3);
+    uint64_t words[Casspir::FixedBitplane<Casspir::ExpertMap::SIZE>::WORDS];
+    for (uint64_t w = 0; w < generated.get_mines().num_words(); w++) {
+        words[w] = generated.get_mines().word(w);
+    }
+
+    Casspir::ExpertMap loaded(words);
+    assert( loaded.get_num_flipped() == 0 );
+    loaded.flip(Casspir::Point(15, 8));
+    Casspir::Map map(30, 16, words);
+    map.flip(Casspir::Point(15, 8));
+    assert_same(loaded, map);
+    assert_same(generated, map);
+}
+
+static void test_no_allocations()
+{
+    uint64_t before = allocations;
+
+    Casspir::ExpertMap map;
+    map.generate_seeded(99, Casspir::Point(15, 8), 1);
+    Casspir::ExpertMap copy = map;
+    copy.flip(Casspir::Point(0, 0));
+    copy.flag(Casspir::Point(29, 15));
+    copy.reset();
+
+    Casspir::BeginnerMap beginner;
+    beginner.generate_seeded(10, Casspir::Point(4, 4), 1);
+
+    assert( allocations == before );
+
+    //Solving allocates only in the context, and not at all once it's grown to fit.
+    std::vector<Casspir::ExpertMap> maps(10);
+    Casspir::SolverContext context;
+    uint64_t flips = 0;
+    Casspir::OperationSink sink = [&flips](const Casspir::Operation&) {
+        flips++;
+    };
+    for (int round = 0; round < 2; round++) {
+        before = allocations;
+        for (uint64_t seed = 0; seed < maps.size(); seed++) {
+            maps[seed].generate_seeded(99, Casspir::Point(15, 8), seed);
+            Casspir::BasicSolver<Casspir::ExpertMap> solver(maps[seed], context);
+            solver.solve(sink);
+        }
+
+        //Statistics keep their own lists.
+        if (round == 1 && !Casspir::SolverStats::ENABLED) {
+            assert( allocations == before );
+        }
+    }
+    assert( flips > 0 );
+}
+
+int main (void)
+{
+    test_plays_like_map<9, 9>(10);
+    test_plays_like_map<16, 16>(40);
+    test_plays_like_map<30, 16>(99);
+    test_plays_like_map<30, 16>(400);
+    test_solves_like_map<9, 9>(10);
+    test_solves_like_map<16, 16>(40);
+    test_solves_like_map<30, 16>(99);
+    test_from_mines();
+    test_no_allocations();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,47 @@
+#include <cassert>
+#include <cstdlib>
+
+#include <casspir.hh>
+#include <Solver.hh>
+
+static void test_no_guess_batch()
+{
+    Casspir::ThreadPool thread_pool(2);
+    Casspir::BatchOptions options(0, 0, &thread_pool);
+    Casspir::BatchResult result = casspir_generate_batch(9,9, 20, Casspir::Point(4,4), 10, options);
+
+    assert( result.maps.size() == 10 );
+    assert( result.attempts >= 10 );
+    assert( result.boards_per_second > 0 );
+
+    for (Casspir::Map& map : result.maps) {
+        //Boards should come back with only the first flip made.
+        assert( map.get_status() == Casspir::MapStatus::IN_PROGRESS );
+        assert( map.get_tile(Casspir::Point(4,4)).flipped );
+        assert( map.get_mines_remaining() == map.get_total_mines() );
+
+        //And be solvable without guessing.
+        Casspir::Solver solver(map);
+        solver.solve();
+        assert( map.get_status() == Casspir::MapStatus::COMPLETE );
+        assert( solver.get_guesses() == 0 );
+    }
+}
+
+static void test_attempt_limit()
+{
+    //Nothing this dense is solvable without guessing, so the attempts run out.
+    Casspir::BatchOptions options(0, 20);
+    Casspir::BatchResult result = casspir_generate_batch(9,9, 255, Casspir::Point(4,4), 5, options);
+
+    assert( result.attempts == 20 );
+    assert( result.maps.size() < 5 );
+}
+
+int main (void)
+{
+    test_no_guess_batch();
+    test_attempt_limit();
+
+    return EXIT_SUCCESS;
+}
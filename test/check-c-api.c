@@ -0,0 +1,113 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include <casspir_c.h>
+
+static void test_c_api(void)
+{
+    /* Two mines in the corners of a 10x10 map. */
+    uint64_t mines[2] = {1, 0};
+    mines[1] |= 1ULL << (99 - 64);
+    casspir_map* map = casspir_map_from_mines(10, 10, mines);
+    assert( map != NULL );
+    assert( casspir_map_width(map) == 10 );
+    assert( casspir_map_mines_remaining(map) == 2 );
+
+    casspir_tile tiles[100];
+    assert( casspir_map_read_tiles(map, tiles, 100) == 100 );
+    assert( tiles[0].mine && tiles[99].mine );
+    assert( tiles[1].value == 1 && tiles[11].value == 1 && tiles[55].value == 0 );
+    assert( !tiles[55].flipped );
+
+    assert( casspir_map_flip(map, 5, 5) == 98 );
+    assert( casspir_map_flip(map, 50, 5) == 0 );
+    casspir_map_read_tiles(map, tiles, 100);
+    assert( tiles[55].flipped && !tiles[0].flipped );
+
+    casspir_map_flag(map, 0, 0);
+    casspir_map_flag(map, 9, 9);
+    assert( casspir_map_status(map) == CASSPIR_COMPLETE );
+    casspir_map_free(map);
+
+    /* Maps over the tile limit are refused before anything is allocated. */
+    uint64_t no_mines[1] = {0};
+    assert( casspir_map_generate(1 << 14, (1 << 14) + 1, 10, 0, 0, 0) == NULL );
+    assert( casspir_map_generate(0xffffffff, 0xffffffff, 10, 0, 0, 0) == NULL );
+    assert( casspir_map_from_mines(1 << 14, (1 << 14) + 1, no_mines) == NULL );
+    assert( casspir_map_from_mines(0, 10, no_mines) == NULL );
+}
+
+static void test_c_solve(void)
+{
+    /* Solve a little at a time into a small buffer. */
+    casspir_map* map = casspir_map_generate(30, 16, 99, 15, 8, 3);
+    casspir_map* copy = casspir_map_copy(map);
+    assert( map != NULL && copy != NULL );
+    assert( casspir_map_generate(30, 16, 99, 30, 8, 3) == NULL );
+
+    casspir_solver* solver = casspir_solver_new(map);
+    uint64_t operations[16];
+    uint64_t total = 0;
+    uint64_t written;
+    do {
+        written = casspir_solver_solve(solver, operations, 16);
+        for (uint64_t i = 0; i < written; i++) {
+            if (CASSPIR_OPERATION_IS_FLAG(operations[i])) {
+                casspir_map_flag(copy, CASSPIR_OPERATION_INDEX(operations[i]) % 30, CASSPIR_OPERATION_INDEX(operations[i]) / 30);
+            } else {
+                casspir_map_flip(copy, CASSPIR_OPERATION_INDEX(operations[i]) % 30, CASSPIR_OPERATION_INDEX(operations[i]) / 30);
+            }
+        }
+        total += written;
+    } while (written == 16);
+    assert( total > 16 );
+
+    /* Replaying the operations plays the same game. */
+    assert( casspir_map_status(copy) == casspir_map_status(map) );
+    assert( casspir_map_num_flipped(copy) == casspir_map_num_flipped(map) );
+
+    casspir_solver_free(solver);
+    casspir_map_free(copy);
+    casspir_map_free(map);
+}
+
+static void test_c_batch(void)
+{
+    casspir_map* maps[4];
+    casspir_solver* solvers[4];
+    uint32_t xs[4], ys[4];
+    uint64_t flipped[4];
+    size_t i;
+    for (i = 0; i < 4; i++) {
+        maps[i] = casspir_map_generate(16, 16, 40, 8, 8, i);
+        casspir_map_reset(maps[i]);
+        solvers[i] = casspir_solver_new(maps[i]);
+        xs[i] = 8;
+        ys[i] = 8;
+    }
+
+    casspir_maps_flip(maps, xs, ys, flipped, 4);
+    for (i = 0; i < 4; i++) {
+        assert( flipped[i] == casspir_map_num_flipped(maps[i]) );
+    }
+
+    uint64_t* operations = malloc(4 * 256 * sizeof(uint64_t));
+    uint64_t num_operations[4];
+    casspir_solvers_solve(solvers, 4, operations, 256, num_operations);
+    for (i = 0; i < 4; i++) {
+        assert( num_operations[i] > 0 );
+        assert( casspir_map_status(maps[i]) != CASSPIR_IN_PROGRESS );
+        casspir_solver_free(solvers[i]);
+        casspir_map_free(maps[i]);
+    }
+    free(operations);
+}
+
+int main (void)
+{
+    test_c_api();
+    test_c_solve();
+    test_c_batch();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+
+#include <ChunkedMap.hh>
+
+static void test_chunked_map()
+{
+    Casspir::ChunkedMap map(42, 600, 0, 0);
+
+    //The first flip is an opening.
+    assert( map.get_status() == Casspir::MapStatus::IN_PROGRESS );
+    assert( map.get_tile(0,0).flipped );
+    assert( map.get_tile(0,0).value == 0 );
+    assert( map.get_num_flipped() > 1 );
+
+    //Only the chunks near the opening exist.
+    uint64_t chunks = map.get_num_chunks();
+    assert( chunks < 16 );
+
+    //Values match the mines around them, across chunk edges and negative coordinates.
+    for (int64_t y = -70; y <= 70; y++) {
+        for (int64_t x = -70; x <= 70; x++) {
+            uint8_t mines = 0;
+            for (int64_t dy = -1; dy <= 1; dy++) {
+                for (int64_t dx = -1; dx <= 1; dx++) {
+                    mines += (dx != 0 || dy != 0) && map.get_tile(x + dx, y + dy).mine;
+                }
+            }
+            assert( map.get_tile(x, y).value == mines );
+        }
+    }
+
+    //Chunks away from the first flip have exactly the requested mines.
+    uint64_t mines = 0;
+    for (int64_t y = 128; y < 192; y++) {
+        for (int64_t x = -64; x < 0; x++) {
+            mines += map.get_tile(x, y).mine;
+        }
+    }
+    assert( mines == 600 );
+
+    //Looking far away only generates what's looked at,
+    //plus the chunks around a corner to work out it's value.
+    chunks = map.get_num_chunks();
+    map.get_tile(1000000005, -1000000005);
+    assert( map.get_num_chunks() == chunks + 1 );
+    map.get_tile(1000000000, -1000000000);
+    assert( map.get_num_chunks() == chunks + 4 );
+    assert( map.get_memory_usage() < 1024 * 1024 );
+}
+
+static void test_chunked_map_seed()
+{
+    //The same seed gives the same map whatever order it's looked at in.
+    Casspir::ChunkedMap a(7, 500, 10, 10);
+    Casspir::ChunkedMap b(7, 500, 10, 10);
+    Casspir::ChunkedMap c(8, 500, 10, 10);
+    b.get_tile(5000, 5000);
+
+    bool differs = false;
+    for (int64_t y = 4990; y < 5010; y++) {
+        for (int64_t x = 4990; x < 5010; x++) {
+            assert( a.get_tile(x, y).mine == b.get_tile(x, y).mine );
+            differs |= a.get_tile(x, y).mine != c.get_tile(x, y).mine;
+        }
+    }
+    assert( differs );
+
+    //Flags stop flips, and flipping a mine loses.
+    int64_t x = 5000;
+    while (!a.get_tile(x, 5000).mine) {
+        x++;
+    }
+    a.flag(x, 5000);
+    assert( a.flip(x, 5000) == 0 );
+    a.flag(x, 5000);
+    a.flip(x, 5000);
+    assert( a.get_status() == Casspir::MapStatus::FAILED );
+}
+
+static void test_chunked_map_far()
+{
+    //Chunks any distance apart are stored apart, even a whole 32 bit chunk coordinate away.
+    Casspir::ChunkedMap map(42, 600, 0, 0);
+    uint64_t chunks = map.get_num_chunks();
+    assert( !map.get_tile(64LL << 32, 0).flipped );
+    assert( map.get_num_chunks() > chunks );
+
+    //Sparser maps are clamped to the lowest density, so the first flip's opening still ends.
+    Casspir::ChunkedMap sparse(42, 0, 0, 0);
+    uint64_t mines = 0;
+    for (int64_t y = 128; y < 192; y++) {
+        for (int64_t x = 0; x < 64; x++) {
+            mines += sparse.get_tile(x, y).mine;
+        }
+    }
+    assert( mines == Casspir::ChunkedMap::MIN_MINES_PER_CHUNK );
+
+    //The map ends just inside the 64 bit coordinates, anything beyond doesn't exist.
+    const int64_t max = Casspir::ChunkedMap::MAX_COORDINATE;
+    const int64_t min = Casspir::ChunkedMap::MIN_COORDINATE;
+    Casspir::ChunkedMap corner(42, 600, max, max);
+    assert( corner.get_status() == Casspir::MapStatus::IN_PROGRESS );
+    assert( corner.get_tile(max, max).flipped );
+    assert( !corner.get_tile(max + 1, max).flipped );
+    assert( corner.get_tile(INT64_MAX, INT64_MAX).value == 0 );
+    assert( corner.flip(INT64_MAX, 0) == 0 );
+    corner.flag(INT64_MIN, 0);
+    assert( !corner.get_tile(INT64_MIN, 0).flagged );
+    corner.flip(min, min);
+    assert( corner.get_tile(min, min).flipped );
+}
+
+int main (void)
+{
+    test_chunked_map();
+    test_chunked_map_seed();
+    test_chunked_map_far();
+
+    return EXIT_SUCCESS;
+}
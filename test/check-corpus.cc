@@ -0,0 +1,139 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include <casspir.hh>
+#include <Corpus.hh>
+
+static void test_corpus()
+{
+    const char* path = "check-corpus.tmp";
+    Casspir::Point click(15,8);
+
+    //Write a few boards, the odd ones with their solutions.
+    std::vector<Casspir::Map> maps;
+    std::vector< std::vector<uint64_t> > solutions;
+    Casspir::CorpusWriter writer;
+    assert( writer.open(path) );
+    for (uint64_t seed = 0; seed < 6; seed++) {
+        maps.push_back(casspir_generate_seeded_map(30,16, 99, click, seed));
+
+        std::vector<uint64_t> operations;
+        if (seed % 2 == 1) {
+            Casspir::Map solved = maps.back();
+            casspir_solve(solved, [&operations](const Casspir::Operation& operation) {
+                operations.push_back(operation.encode(30));
+            });
+        }
+        solutions.push_back(operations);
+
+        assert( writer.add(maps.back(), click, operations) );
+    }
+    assert( writer.close() );
+
+    Casspir::CorpusReader reader;
+    assert( reader.open(path) );
+    assert( reader.size() == maps.size() );
+
+    //Read them back out of order.
+    for (uint64_t board = maps.size(); board-- > 0;) {
+        assert( reader.get_width(board) == 30 );
+        assert( reader.get_height(board) == 16 );
+        assert( reader.get_click(board) == click );
+
+        Casspir::Map map = reader.get_map(board);
+        assert( map.get_total_mines() == 99 );
+        assert( map.get_num_flipped() == maps[board].get_num_flipped() );
+        for (uint64_t i = 0; i < map.get_size(); i++) {
+            assert( map.is_mine(i) == maps[board].is_mine(i) );
+            assert( map.get_value(i) == maps[board].get_value(i) );
+        }
+
+        assert( reader.get_num_operations(board) == solutions[board].size() );
+        for (uint64_t i = 0; i < solutions[board].size(); i++) {
+            Casspir::Operation operation = reader.get_operation(board, i);
+            assert( operation.encode(30) == solutions[board][i] );
+        }
+    }
+
+    reader.close();
+    assert( reader.size() == 0 );
+
+    //Anything else is rejected.
+    {
+        std::ofstream garbage(path, std::ios::binary | std::ios::trunc);
+        garbage << "not a corpus, just some text padding it out";
+    }
+    assert( !reader.open(path) );
+    assert( !reader.open("check-corpus.missing") );
+
+    std::remove(path);
+}
+
+/**
+ * Write a one board corpus, overwrite a word of it, and try to open it.
+ */
+static bool open_corrupted(const char* path, uint64_t (*position)(const Casspir::CorpusFormat::Header&), uint64_t value)
+{
+    Casspir::Map map = casspir_generate_seeded_map(30,16, 99, Casspir::Point(15,8), 0);
+    Casspir::CorpusWriter writer;
+    assert( writer.open(path) );
+    assert( writer.add(map, Casspir::Point(15,8)) );
+    assert( writer.close() );
+
+    std::vector<char> bytes;
+    {
+        std::ifstream file(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    Casspir::CorpusFormat::Header header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    std::memcpy(bytes.data() + position(header), &value, sizeof(value));
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), bytes.size());
+    }
+
+    Casspir::CorpusReader reader;
+    return reader.open(path);
+}
+
+static void test_corrupted()
+{
+    const char* path = "check-corpus-corrupted.tmp";
+
+    //Unchanged it opens.
+    auto first_board = [](const Casspir::CorpusFormat::Header&) -> uint64_t {
+        return sizeof(Casspir::CorpusFormat::Header);
+    };
+    assert( open_corrupted(path, first_board, 30 | (16ULL << 32)) );
+
+    //An index entry so big that adding the board header wraps around.
+    auto index_entry = [](const Casspir::CorpusFormat::Header& header) -> uint64_t {
+        return header.index_offset;
+    };
+    assert( !open_corrupted(path, index_entry, ~7ULL) );
+
+    //An operation count that wraps around when added to the mine words.
+    auto num_operations = [](const Casspir::CorpusFormat::Header&) -> uint64_t {
+        return sizeof(Casspir::CorpusFormat::Header) + offsetof(Casspir::CorpusFormat::BoardHeader, num_operations);
+    };
+    assert( !open_corrupted(path, num_operations, 0 - (30*16 + 63) / 64) );
+    assert( !open_corrupted(path, num_operations, ~0ULL) );
+
+    std::remove(path);
+}
+
+int main (void)
+{
+    test_corpus();
+    test_corrupted();
+
+    return EXIT_SUCCESS;
+}
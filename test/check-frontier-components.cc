@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+#include <casspir.hh>
+#include <FrontierComponents.hh>
+
+static void test_separate_components()
+{
+    //Mines in opposite corners, opened from the middle, leave two separate borders.
+    std::set<Casspir::Point> mines = {
+        Casspir::Point(0,0),
+        Casspir::Point(6,6)
+    };
+    Casspir::Map map = casspir_make_map(7,7, mines);
+    map.flip(Casspir::Point(3,3));
+
+    Casspir::FrontierComponents components;
+    components.compute(map);
+    assert( components.size() == 2 );
+
+    //The top left corner is found first, bordered by the three 1s around it.
+    assert( components.get_num_cells(0) == 1 );
+    assert( components.get_cells(0)[0] == 0 );
+    assert( components.get_num_numbers(0) == 3 );
+    const uint64_t expected_numbers[] = {1, 7, 8};
+    assert( std::equal(expected_numbers, expected_numbers + 3, components.get_numbers(0)) );
+
+    assert( components.get_num_cells(1) == 1 );
+    assert( components.get_cells(1)[0] == 48 );
+    assert( components.get_num_numbers(1) == 3 );
+
+    //Flagging a mine takes it's component away.
+    map.flag(Casspir::Point(0,0));
+    components.compute(map);
+    assert( components.size() == 1 );
+    assert( components.get_cells(0)[0] == 48 );
+}
+
+static void test_long_frontier()
+{
+    //A wall of mines across a large board gives one component the width of the board.
+    std::set<Casspir::Point> mines;
+    for (uint32_t x = 0; x < 1000; x++) {
+        mines.insert(Casspir::Point(x, 500));
+    }
+    Casspir::Map map = casspir_make_map(1000,1000, mines);
+    map.flip(Casspir::Point(0,0));
+
+    Casspir::FrontierComponents components;
+    components.compute(map);
+    assert( components.size() == 1 );
+    assert( components.get_num_cells(0) == 1000 );
+    assert( components.get_num_numbers(0) == 1000 );
+
+    std::vector<uint64_t> cells(components.get_cells(0), components.get_cells(0) + 1000);
+    std::sort(cells.begin(), cells.end());
+    for (uint64_t x = 0; x < 1000; x++) {
+        assert( cells[x] == 500 * 1000 + x );
+    }
+
+    //Numbers come in index order.
+    assert( std::is_sorted(components.get_numbers(0), components.get_numbers(0) + 1000) );
+}
+
+static void test_reused_between_maps()
+{
+    //The same components, whatever board was split before.
+    std::set<Casspir::Point> wall;
+    for (uint32_t x = 0; x < 1000; x++) {
+        wall.insert(Casspir::Point(x, 500));
+    }
+    Casspir::Map large = casspir_make_map(1000,1000, wall);
+    large.flip(Casspir::Point(0,0));
+
+    std::set<Casspir::Point> corners = {
+        Casspir::Point(0,0),
+        Casspir::Point(6,6)
+    };
+    Casspir::Map small = casspir_make_map(7,7, corners);
+    small.flip(Casspir::Point(3,3));
+
+    Casspir::FrontierComponents components;
+    for (int i = 0; i < 2; i++) {
+        components.compute(small);
+        assert( components.size() == 2 );
+        assert( components.get_cells(0)[0] == 0 );
+        assert( components.get_cells(1)[0] == 48 );
+
+        components.compute(large);
+        assert( components.size() == 1 );
+        assert( components.get_num_cells(0) == 1000 );
+    }
+}
+
+int main (void)
+{
+    test_separate_components();
+    test_long_frontier();
+    test_reused_between_maps();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+#include <cassert>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+#include <casspir.hh>
+#include <FrontierComponents.hh>
+#include <FrontierEquations.hh>
+#include <Solver.hh>
+
+/**
+ * Exposes the elimination pass on it's own.
+ */
+class EliminationSolver : public Casspir::Solver
+{
+    public:
+        EliminationSolver(Casspir::Map& map) : Casspir::Solver(map) {}
+
+        using Casspir::Solver::perform_basic_pass;
+        using Casspir::Solver::perform_elimination_pass;
+};
+
+/**
+ * Reduce the equations of the map's only component.
+ */
+static void reduce(Casspir::Map& map, Casspir::FrontierEquations& equations)
+{
+    Casspir::FrontierComponents components;
+    components.compute(map);
+    assert( components.size() == 1 );
+    equations.reduce(
+        map,
+        components.get_cells(0),
+        components.get_num_cells(0),
+        components.get_numbers(0),
+        components.get_num_numbers(0)
+    );
+}
+
+static void test_reduce()
+{
+    //A 1-1-2-1-1 row under the unflipped top row, no single number decides anything.
+    std::set<Casspir::Point> mines = {
+        Casspir::Point(1,0),
+        Casspir::Point(3,0)
+    };
+    Casspir::Map map = casspir_make_map(5,3, mines);
+    map.flip(Casspir::Point(2,2));
+
+    //Together the numbers decide the whole row.
+    Casspir::FrontierEquations equations;
+    reduce(map, equations);
+    assert( equations.is_consistent() );
+    assert( (equations.get_safe() == std::vector<uint64_t>{0, 2, 4}) );
+    assert( (equations.get_mines() == std::vector<uint64_t>{1, 3}) );
+
+    //A wrong flag leaves the 2 needing two mines from tiles the 1s show are safe.
+    map.flag(Casspir::Point(0,0));
+    reduce(map, equations);
+    assert( !equations.is_consistent() );
+    assert( equations.get_safe().empty() );
+    assert( equations.get_mines().empty() );
+}
+
+static void test_large_component()
+{
+    //A wall of mines across the board is one component, far too big to enumerate.
+    std::set<Casspir::Point> mines;
+    for (uint32_t x = 0; x < 1000; x++) {
+        mines.insert(Casspir::Point(x, 500));
+    }
+    Casspir::Map map = casspir_make_map(1000,1000, mines);
+    map.flip(Casspir::Point(0,0));
+
+    Casspir::FrontierEquations equations;
+    reduce(map, equations);
+    assert( equations.is_consistent() );
+    assert( equations.get_safe().empty() );
+    assert( equations.get_mines().size() == 1000 );
+    for (uint64_t x = 0; x < 1000; x++) {
+        assert( equations.get_mines()[x] == 500 * 1000 + x );
+    }
+}
+
+static void test_long_component()
+{
+    //Every third tile of a long row is a mine, each number touching exactly one,
+    //and the row ending on a mine pins down which.
+    //Reducing costs in proportion to the rows' terms, so this is quick however long the row.
+    const uint32_t length = 60001;
+    std::set<Casspir::Point> mines;
+    for (uint32_t x = 0; x < length; x += 3) {
+        mines.insert(Casspir::Point(x, 1));
+    }
+    Casspir::Map map = casspir_make_map(length,3, mines);
+    for (uint32_t x = 0; x < length; x++) {
+        map.flip(Casspir::Point(x, 0));
+    }
+
+    Casspir::FrontierEquations equations;
+    reduce(map, equations);
+    assert( equations.is_consistent() );
+    assert( equations.get_mines().size() == mines.size() );
+    assert( equations.get_safe().size() == length - mines.size() );
+    for (uint64_t mine : equations.get_mines()) {
+        assert( mine % 3 == length % 3 && mine / length == 1 );
+    }
+}
+
+static void test_elimination_pass()
+{
+    std::set<Casspir::Point> mines = {
+        Casspir::Point(1,0),
+        Casspir::Point(3,0)
+    };
+    Casspir::Map map = casspir_make_map(5,3, mines);
+    map.flip(Casspir::Point(2,2));
+
+    EliminationSolver solver(map);
+    assert( !solver.perform_basic_pass() );
+    assert( solver.perform_elimination_pass() );
+    assert( map.get_status() == Casspir::MapStatus::COMPLETE );
+    assert( map.get_tile(Casspir::Point(1,0)).flagged );
+    assert( map.get_tile(Casspir::Point(3,0)).flagged );
+}
+
+int main (void)
+{
+    test_reduce();
+    test_large_component();
+    test_long_component();
+    test_elimination_pass();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,158 @@
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <casspir.hh>
+#include <FrontierGroup.hh>
+#include <Solver.hh>
+
+static void test_frontier_group()
+{
+    //Two mines along the bottom row, the top two rows are revealed by the first flip.
+    std::set<Casspir::Point> mines = {
+        Casspir::Point(1,2),
+        Casspir::Point(3,2)
+    };
+    Casspir::Map map = casspir_make_map(5,3, mines);
+    map.flip(Casspir::Point(0,0));
+    assert( map.get_num_flipped() == 10 );
+
+    std::vector<uint64_t> cells = {10, 11, 12, 13, 14};
+    std::vector<uint64_t> numbers = {5, 6, 7, 8, 9};
+    Casspir::FrontierGroup group(map, cells, numbers);
+    assert( group.size() == 5 );
+
+    //The 1-1-2-1-1 row only has one solution.
+    group.enumerate(2);
+    assert( group.get_solutions() == 1 );
+    for (size_t i = 0; i < group.size(); i++) {
+        bool mine = group.get_cell(i) == 11 || group.get_cell(i) == 13;
+        assert( group.get_tally(i) == mine );
+    }
+
+    //Without enough mines there are no solutions.
+    group.enumerate(1);
+    assert( group.get_solutions() == 0 );
+
+    //Flags outside the group count against the numbers.
+    map.flag(Casspir::Point(3,2));
+    std::vector<uint64_t> left_cells = {10, 11, 12};
+    std::vector<uint64_t> left_numbers = {5, 6, 7, 8};
+    Casspir::FrontierGroup left(map, left_cells, left_numbers);
+    left.enumerate(1);
+    assert( left.get_solutions() == 1 );
+
+    //Evaluating a group leaves the map alone.
+    assert( map.get_flagged().count() == 1 );
+    assert( map.get_num_flipped() == 10 );
+}
+
+static void test_same_constraints()
+{
+    std::set<Casspir::Point> mines = {
+        Casspir::Point(1,2),
+        Casspir::Point(3,2)
+    };
+    Casspir::Map map = casspir_make_map(5,3, mines);
+    map.flip(Casspir::Point(0,0));
+
+    std::vector<uint64_t> cells = {10, 11, 12, 13, 14};
+    std::vector<uint64_t> numbers = {5, 6, 7, 8, 9};
+    Casspir::FrontierGroup group(map, cells, numbers);
+    Casspir::FrontierGroup same(map, cells, numbers);
+    assert( group.get_signature() == same.get_signature() );
+    assert( group.has_same_constraints(same) );
+
+    //Counts taken from an enumerated group are the same as enumerating.
+    group.enumerate(2);
+    assert( !same.is_enumerated(2) );
+    same.copy_counts(group);
+    assert( same.is_enumerated(2) );
+    assert( !same.is_enumerated(1) );
+    assert( same.get_solutions() == group.get_solutions() );
+    for (size_t i = 0; i < same.size(); i++) {
+        assert( same.get_tally(i) == group.get_tally(i) );
+    }
+
+    //A flag changes what the numbers need, so the same cells no longer match.
+    std::vector<uint64_t> left_cells = {10, 11, 12};
+    std::vector<uint64_t> left_numbers = {5, 6, 7, 8};
+    Casspir::FrontierGroup before(map, left_cells, left_numbers);
+    map.flag(Casspir::Point(3,2));
+    Casspir::FrontierGroup after(map, left_cells, left_numbers);
+    assert( !after.has_same_constraints(before) );
+}
+
+/**
+ * An 11x7 lattice of numbers two apart, with a third of the other tiles mines.
+ * The numbers constrain the whole board as one 62 tile group with over a billion solutions,
+ * which took minutes to enumerate in full.
+ */
+static Casspir::Map make_lattice(std::vector<uint64_t>& cells, std::vector<uint64_t>& numbers)
+{
+    std::mt19937 r_engine(1);
+    std::set<Casspir::Point> lattice, mines;
+    for (uint32_t y = 1; y < 7; y += 2) {
+        for (uint32_t x = 1; x < 11; x += 2) {
+            lattice.insert(Casspir::Point(x,y));
+        }
+    }
+    for (uint32_t y = 0; y < 7; y++) {
+        for (uint32_t x = 0; x < 11; x++) {
+            if (lattice.count(Casspir::Point(x,y)) == 0 && r_engine() % 100 < 35) {
+                mines.insert(Casspir::Point(x,y));
+            }
+        }
+    }
+
+    Casspir::Map map = casspir_make_map(11,7, mines);
+    for (const Casspir::Point& point : lattice) {
+        map.flip(point);
+        numbers.push_back(point.get_index(11));
+    }
+    for (uint64_t i = 0; i < map.get_size(); i++) {
+        if (!map.is_flipped(i)) {
+            cells.push_back(i);
+        }
+    }
+    return map;
+}
+
+static void test_work_limit()
+{
+    std::vector<uint64_t> cells, numbers;
+    Casspir::Map map = make_lattice(cells, numbers);
+    assert( cells.size() == 62 );
+
+    //The search stops once it's out of work, and says so.
+    Casspir::FrontierGroup group(map, cells, numbers);
+    group.enumerate(map.get_mines_remaining(), 1 << 20);
+    assert( group.is_enumerated(map.get_mines_remaining()) );
+    assert( group.is_exhausted() );
+
+    //Copies carry it, so a cached group isn't searched again.
+    Casspir::FrontierGroup copy;
+    copy.copy_counts(group);
+    assert( copy.is_exhausted() );
+
+    //The solver drops the group instead, so solving the board takes around a second rather than minutes.
+    //The bound leaves room for sanitizer and debug builds.
+    auto start = std::chrono::steady_clock::now();
+    Casspir::Solver solver(map);
+    solver.solve();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    assert( map.get_status() != Casspir::MapStatus::IN_PROGRESS );
+    assert( elapsed.count() < 60 );
+}
+
+int main (void)
+{
+    test_frontier_group();
+    test_same_constraints();
+    test_work_limit();
+
+    return EXIT_SUCCESS;
+}
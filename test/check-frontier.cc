@@ -0,0 +1,102 @@
+#include <cassert>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+#include <casspir.hh>
+
+/**
+ * Recompute the frontier from scratch and compare it to the tracked one.
+ */
+static void assert_frontier_consistent(Casspir::Map& map)
+{
+    uint64_t size = 0;
+    for (uint64_t i = 0; i < map.get_size(); i++) {
+        Casspir::TileState tile = map.get_tile(i);
+        bool expected = false;
+        if (tile.flipped && !tile.mine && tile.value > 0) {
+            for (uint64_t neighbour : map.get_neighbours(i)) {
+                if (!map.is_flipped(neighbour) && !map.is_flagged(neighbour)) {
+                    expected = true;
+                }
+            }
+        }
+        assert( map.is_frontier(i) == expected );
+        size += expected;
+    }
+    assert( map.get_frontier_size() == size );
+}
+
+static void test_frontier()
+{
+    std::set<Casspir::Point> mines = {
+        Casspir::Point(3,1),
+        Casspir::Point(6,0),
+        Casspir::Point(8,3),
+        Casspir::Point(4,4),
+        Casspir::Point(6,9),
+        Casspir::Point(1,7),
+        Casspir::Point(8,0),
+        Casspir::Point(7,3),
+        Casspir::Point(3,6),
+        Casspir::Point(5,4)
+    };
+    Casspir::Map map = casspir_make_map(10,10, mines);
+    std::vector<uint64_t> dirty;
+
+    //Nothing is flipped so nothing is on the frontier.
+    assert( map.get_frontier_size() == 0 );
+
+    map.flip(Casspir::Point(0,2));
+    assert_frontier_consistent(map);
+
+    //Every frontier tile should have been reported dirty.
+    map.take_dirty_tiles(dirty);
+    assert( dirty.size() == map.get_frontier_size() );
+    for (uint64_t i : dirty) {
+        assert( map.is_frontier(i) );
+    }
+
+    //Taking the dirty tiles empties the list.
+    map.take_dirty_tiles(dirty);
+    assert( dirty.empty() );
+
+    //Flagging a mine dirties the revealed numbers around it.
+    map.flag(Casspir::Point(3,1));
+    assert_frontier_consistent(map);
+    map.take_dirty_tiles(dirty);
+    assert( !dirty.empty() );
+    for (uint64_t i : dirty) {
+        assert( map.is_frontier(i) );
+    }
+
+    map.flip(Casspir::Point(9,9));
+    assert_frontier_consistent(map);
+
+    map.flag(Casspir::Point(3,1));
+    assert_frontier_consistent(map);
+
+    map.reset();
+    assert( map.get_frontier_size() == 0 );
+    assert_frontier_consistent(map);
+}
+
+static void test_frontier_after_solve()
+{
+    for (uint32_t i = 0; i < 10; i++) {
+        Casspir::Map map = casspir_generate_map(30,16, 60, Casspir::Point(15,8));
+        assert_frontier_consistent(map);
+
+        casspir_solve(map);
+        assert_frontier_consistent(map);
+        assert( map.get_status() != Casspir::MapStatus::IN_PROGRESS );
+    }
+}
+
+int main (void)
+{
+    test_frontier();
+    test_frontier_after_solve();
+
+    return EXIT_SUCCESS;
+}
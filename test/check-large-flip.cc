@@ -0,0 +1,32 @@
+#include <cassert>
+#include <cstdlib>
+#include <set>
+
+#include <casspir.hh>
+
+static void test_large_flip()
+{
+    //A single mine in the far corner, the opening click floods everything else.
+    std::set<Casspir::Point> mines = {
+        Casspir::Point(1999,1999)
+    };
+    Casspir::Map map = casspir_make_map(2000,2000, mines);
+
+    //Every tile except the mine should be flipped.
+    assert( map.flip(Casspir::Point(0,0)) == 2000*2000 - 1 );
+    assert( map.get_num_flipped() == 2000*2000 - 1 );
+
+    //The game should be in progress until the mine is flagged.
+    assert( map.get_status() == Casspir::MapStatus::IN_PROGRESS );
+
+    map.flag(Casspir::Point(1999,1999));
+
+    assert( map.get_status() == Casspir::MapStatus::COMPLETE );
+}
+
+int main (void)
+{
+    test_large_flip();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+#include <cassert>
+#include <cstdlib>
+#include <set>
+
+#include <casspir.hh>
+
+/**
+ * Check two maps have the same tiles, frontier and counts.
+ */
+static void assert_same(Casspir::Map& a, Casspir::Map& b)
+{
+    std::vector<Casspir::TileState> a_state = a.get_state();
+    std::vector<Casspir::TileState> b_state = b.get_state();
+    for (uint64_t i = 0; i < a.get_size(); i++) {
+        assert( a_state[i].flagged == b_state[i].flagged );
+        assert( a_state[i].flipped == b_state[i].flipped );
+        assert( a.is_frontier(i) == b.is_frontier(i) );
+    }
+
+    assert( a.get_num_flipped() == b.get_num_flipped() );
+    assert( a.get_mines_remaining() == b.get_mines_remaining() );
+    assert( a.get_frontier_size() == b.get_frontier_size() );
+    assert( a.get_status() == b.get_status() );
+}
+
+static void test_rollback_flood()
+{
+    //A single mine in the corner, so any other flip floods almost everything.
+    std::set<Casspir::Point> mines = { Casspir::Point(0,0) };
+    Casspir::Map map = casspir_make_map(50,50, mines);
+    map.flip(Casspir::Point(1,1));
+    Casspir::Map before = map;
+
+    uint64_t token = map.checkpoint();
+    assert( map.has_checkpoint() );
+    assert( map.flip(Casspir::Point(49,49)) == 2498 );
+
+    map.rollback(token);
+    assert( !map.has_checkpoint() );
+    assert_same(map, before);
+}
+
+static void test_rollback_failure()
+{
+    std::set<Casspir::Point> mines = { Casspir::Point(0,0), Casspir::Point(4,4) };
+    Casspir::Map map = casspir_make_map(5,5, mines);
+    map.flip(Casspir::Point(2,2));
+    Casspir::Map before = map;
+
+    //Flagging then hitting a mine should all come undone.
+    uint64_t token = map.checkpoint();
+    map.flag(Casspir::Point(0,0));
+    map.flip(Casspir::Point(4,4));
+    assert( map.get_status() == Casspir::MapStatus::FAILED );
+
+    map.rollback(token);
+    assert_same(map, before);
+    assert( map.get_status() == Casspir::MapStatus::IN_PROGRESS );
+}
+
+static void test_nested_checkpoints()
+{
+    std::set<Casspir::Point> mines = { Casspir::Point(0,0), Casspir::Point(4,4) };
+    Casspir::Map map = casspir_make_map(5,5, mines);
+    Casspir::Map start = map;
+
+    uint64_t outer = map.checkpoint();
+    map.flip(Casspir::Point(2,2));
+    Casspir::Map middle = map;
+
+    //Undoing a later checkpoint leaves the earlier one's changes.
+    uint64_t inner = map.checkpoint();
+    assert( inner == outer + 1 );
+    map.flag(Casspir::Point(0,0));
+    map.rollback(inner);
+    assert_same(map, middle);
+    assert( map.has_checkpoint() );
+
+    //Releasing keeps the changes, but they're still undone with the earlier checkpoint.
+    inner = map.checkpoint();
+    map.flag(Casspir::Point(0,0));
+    map.release(inner);
+    assert( map.get_tile(Casspir::Point(0,0)).flagged );
+
+    map.rollback(outer);
+    assert_same(map, start);
+    assert( !map.has_checkpoint() );
+
+    //Reset drops every checkpoint.
+    map.checkpoint();
+    map.reset();
+    assert( !map.has_checkpoint() );
+}
+
+static void test_replay()
+{
+    Casspir::Map map = casspir_generate_seeded_map(30,16, 99, Casspir::Point(15,8), 20);
+    Casspir::Map solved = map;
+    casspir_solve(solved, [](const Casspir::Operation&) {});
+
+    //A game played and rolled back can be played again the same way.
+    uint64_t token = map.checkpoint();
+    casspir_solve(map, [](const Casspir::Operation&) {});
+    map.rollback(token);
+    casspir_solve(map, [](const Casspir::Operation&) {});
+    assert_same(map, solved);
+}
+
+int main (void)
+{
+    test_rollback_flood();
+    test_rollback_failure();
+    test_nested_checkpoints();
+    test_replay();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+#include <casspir.hh>
+#include <FrontierGroup.hh>
+#include <MineProbabilities.hh>
+#include <Solver.hh>
+
+static bool close(double a, double b)
+{
+    return std::fabs(a - b) < 1e-9;
+}
+
+static void test_interior_weighting()
+{
+    //A 1 touching two tiles, with three unconstrained tiles and one more mine beyond it.
+    std::set<Casspir::Point> mines = {
+        Casspir::Point(0,0),
+        Casspir::Point(5,0)
+    };
+    Casspir::Map map = casspir_make_map(6,1, mines);
+    map.flip(Casspir::Point(1,0));
+
+    std::vector<Casspir::FrontierGroup> groups;
+    groups.emplace_back(map, std::vector<uint64_t>{0, 2}, std::vector<uint64_t>{1});
+    groups[0].enumerate(2);
+    assert( groups[0].get_solutions() == 2 );
+    assert( groups[0].get_solutions(1) == 2 );
+    assert( groups[0].get_solutions(0) == 0 );
+
+    Casspir::MineProbabilities probabilities;
+    probabilities.compute(groups, 3, 2);
+    assert( probabilities.is_consistent() );
+    assert( close(probabilities.get_probability(0, 0), .5) );
+    assert( close(probabilities.get_probability(0, 1), .5) );
+    assert( close(probabilities.get_interior_probability(), 1./3) );
+
+    //Far more mines than the group can hold go in a huge interior.
+    probabilities.compute(groups, 1000000, 200001);
+    assert( probabilities.is_consistent() );
+    assert( close(probabilities.get_probability(0, 0), .5) );
+    assert( close(probabilities.get_interior_probability(), .2) );
+
+    //Without enough mines for the group nothing fits.
+    probabilities.compute(groups, 3, 0);
+    assert( !probabilities.is_consistent() );
+}
+
+static void test_mine_count()
+{
+    //Two separate 1s each need one mine, which is all of them, so the tile between is safe.
+    std::set<Casspir::Point> mines = {
+        Casspir::Point(0,0),
+        Casspir::Point(6,0)
+    };
+    Casspir::Map map = casspir_make_map(7,1, mines);
+    map.flip(Casspir::Point(1,0));
+    map.flip(Casspir::Point(5,0));
+
+    std::vector<Casspir::FrontierGroup> groups;
+    groups.emplace_back(map, std::vector<uint64_t>{0, 2}, std::vector<uint64_t>{1});
+    groups.emplace_back(map, std::vector<uint64_t>{4, 6}, std::vector<uint64_t>{5});
+    for (Casspir::FrontierGroup& group : groups) {
+        group.enumerate(2);
+    }
+
+    Casspir::MineProbabilities probabilities;
+    probabilities.compute(groups, 1, 2);
+    assert( probabilities.is_consistent() );
+    assert( probabilities.get_interior_probability() == 0 );
+    for (size_t g = 0; g < groups.size(); g++) {
+        for (size_t i = 0; i < groups[g].size(); i++) {
+            assert( close(probabilities.get_probability(g, i), .5) );
+        }
+    }
+
+    //With a flag down only one mine is left, so the flagged side's group is all safe.
+    map.flag(Casspir::Point(0,0));
+    std::vector<Casspir::FrontierGroup> flagged_groups;
+    flagged_groups.emplace_back(map, std::vector<uint64_t>{2}, std::vector<uint64_t>{1});
+    flagged_groups.emplace_back(map, std::vector<uint64_t>{4, 6}, std::vector<uint64_t>{5});
+    for (Casspir::FrontierGroup& group : flagged_groups) {
+        group.enumerate(1);
+    }
+
+    probabilities.compute(flagged_groups, 1, 1);
+    assert( probabilities.is_consistent() );
+    assert( probabilities.get_probability(0, 0) == 0 );
+    assert( probabilities.get_interior_probability() == 0 );
+}
+
+static void test_solver_uses_mine_count()
+{
+    //Only the mine count shows the middle tile is safe, which opens up the rest.
+    std::set<Casspir::Point> mines = {
+        Casspir::Point(0,0),
+        Casspir::Point(6,0)
+    };
+    Casspir::Map map = casspir_make_map(7,1, mines);
+    map.flip(Casspir::Point(1,0));
+    map.flip(Casspir::Point(5,0));
+
+    Casspir::Solver solver(map);
+    solver.solve();
+    assert( map.get_status() == Casspir::MapStatus::COMPLETE );
+    assert( solver.get_guesses() == 0 );
+}
+
+int main (void)
+{
+    test_interior_weighting();
+    test_mine_count();
+    test_solver_uses_mine_count();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+#include <cassert>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+#include <casspir.hh>
+#include <BasicMap.hh>
+
+static void test_neighbours()
+{
+    Casspir::Map map = casspir_make_map(10,8, std::set<Casspir::Point>());
+
+    //Corners have 3 neighbours
+    assert( map.get_neighbours(0).size() == 3 );
+    assert( map.get_neighbours(9).size() == 3 );
+    assert( map.get_neighbours(70).size() == 3 );
+    assert( map.get_neighbours(79).size() == 3 );
+
+    //Edges have 5 neighbours
+    assert( map.get_neighbours(5).size() == 5 );
+    assert( map.get_neighbours(30).size() == 5 );
+    assert( map.get_neighbours(39).size() == 5 );
+    assert( map.get_neighbours(75).size() == 5 );
+
+    //Interior tiles have 8 neighbours, in ascending order
+    Casspir::Neighbours neighbours = map.get_neighbours(Casspir::Point(4,3).get_index(10));
+    uint64_t expected[] = {23, 24, 25, 33, 35, 43, 44, 45};
+    assert( neighbours.size() == 8 );
+    for (size_t i = 0; i < neighbours.size(); i++) {
+        assert( neighbours.indices[i] == expected[i] );
+    }
+
+    //The set variant should agree with the index variant everywhere
+    for (uint64_t i = 0; i < 80; i++) {
+        Casspir::Point position = Casspir::Point::from_index(i, 10);
+        std::set<Casspir::Point> from_set = map.get_neighbours(position);
+        std::set<Casspir::Point> from_indices;
+        for (uint64_t neighbour : map.get_neighbours(i)) {
+            from_indices.insert(Casspir::Point::from_index(neighbour, 10));
+        }
+        assert( from_set == from_indices );
+    }
+}
+
+/**
+ * Fixed size boards look neighbours up in a table, which should give the same as working them out.
+ */
+template <uint32_t W, uint32_t H>
+static void test_standard_size()
+{
+    Casspir::BasicMap<W, H> fixed;
+    Casspir::Map map = casspir_make_map(W,H, std::set<Casspir::Point>());
+
+    for (uint32_t y = 0; y < H; y++) {
+        for (uint32_t x = 0; x < W; x++) {
+            std::vector<uint64_t> expected;
+            for (int64_t ny = int64_t(y) - 1; ny <= int64_t(y) + 1; ny++) {
+                for (int64_t nx = int64_t(x) - 1; nx <= int64_t(x) + 1; nx++) {
+                    if (nx >= 0 && ny >= 0 && nx < W && ny < H && (nx != x || ny != y)) {
+                        expected.push_back(ny * W + nx);
+                    }
+                }
+            }
+
+            uint64_t index = Casspir::Point(x, y).get_index(W);
+            Casspir::Neighbours neighbours = map.get_neighbours(index);
+            assert( std::vector<uint64_t>(neighbours.begin(), neighbours.end()) == expected );
+            neighbours = fixed.get_neighbours(index);
+            assert( std::vector<uint64_t>(neighbours.begin(), neighbours.end()) == expected );
+        }
+    }
+}
+
+int main (void)
+{
+    test_neighbours();
+    test_standard_size<9, 9>();
+    test_standard_size<16, 16>();
+    test_standard_size<30, 16>();
+
+    return EXIT_SUCCESS;
+}
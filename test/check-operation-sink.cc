@@ -0,0 +1,54 @@
+#include <cassert>
+#include <cstdlib>
+#include <queue>
+#include <vector>
+
+#include <casspir.hh>
+
+static void test_operation_sink()
+{
+    for (uint64_t seed = 0; seed < 10; seed++) {
+        Casspir::Map queued_map = casspir_generate_seeded_map(30,16, 80, Casspir::Point(15,8), seed);
+        Casspir::Map streamed_map = queued_map;
+
+        std::queue<Casspir::Operation> queued = casspir_solve(queued_map);
+
+        //Stream packed operations straight into a buffer.
+        std::vector<uint64_t> streamed;
+        casspir_solve(streamed_map, [&streamed](const Casspir::Operation& operation) {
+            streamed.push_back(operation.encode(30));
+        });
+
+        //Both should play exactly the same game.
+        assert( queued.size() == streamed.size() );
+        for (uint64_t encoded : streamed) {
+            Casspir::Operation operation = Casspir::Operation::decode(encoded, 30);
+            assert( operation.type == queued.front().type );
+            assert( operation.position == queued.front().position );
+            queued.pop();
+        }
+        assert( queued_map.get_status() == streamed_map.get_status() );
+    }
+}
+
+static void test_operation_encoding()
+{
+    Casspir::Operation flip(Casspir::OperationType::FLIP, Casspir::Point(3,2));
+    Casspir::Operation flag(Casspir::OperationType::FLAG, Casspir::Point(3,2));
+
+    //Index in the high bits, type in the low bit.
+    assert( flip.encode(10) == 46 );
+    assert( flag.encode(10) == 47 );
+
+    Casspir::Operation decoded = Casspir::Operation::decode(flag.encode(10), 10);
+    assert( decoded.type == Casspir::OperationType::FLAG );
+    assert( decoded.position == Casspir::Point(3,2) );
+}
+
+int main (void)
+{
+    test_operation_encoding();
+    test_operation_sink();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,63 @@
+#include <cassert>
+#include <cstdlib>
+#include <set>
+
+#include <casspir.hh>
+#include <Solver.hh>
+
+/**
+ * Exposes the pair pass on it's own.
+ */
+class PairSolver : public Casspir::Solver
+{
+    public:
+        PairSolver(Casspir::Map& map) : Casspir::Solver(map) {}
+
+        using Casspir::Solver::perform_basic_pass;
+        using Casspir::Solver::perform_pair_pass;
+};
+
+static void test_pair_pass()
+{
+    //A 1-1-2-1-1 row under the unflipped top row, the rest is open.
+    std::set<Casspir::Point> mines = {
+        Casspir::Point(1,0),
+        Casspir::Point(3,0)
+    };
+    Casspir::Map map = casspir_make_map(5,3, mines);
+    map.flip(Casspir::Point(2,2));
+    assert( map.get_num_flipped() == 10 );
+
+    //No single number decides anything.
+    PairSolver solver(map);
+    assert( !solver.perform_basic_pass() );
+
+    //The 1s either side of the 2 show the tile above it is safe, and the 2 then needs a mine on the right.
+    assert( solver.perform_pair_pass() );
+    assert( map.get_tile(Casspir::Point(2,0)).flipped );
+    assert( map.get_tile(Casspir::Point(3,0)).flagged );
+    assert( !map.get_tile(Casspir::Point(1,0)).flipped );
+}
+
+static void test_pair_solve()
+{
+    std::set<Casspir::Point> mines = {
+        Casspir::Point(1,0),
+        Casspir::Point(3,0)
+    };
+    Casspir::Map map = casspir_make_map(5,3, mines);
+    map.flip(Casspir::Point(2,2));
+
+    Casspir::Solver solver(map);
+    solver.solve();
+    assert( map.get_status() == Casspir::MapStatus::COMPLETE );
+    assert( solver.get_guesses() == 0 );
+}
+
+int main (void)
+{
+    test_pair_pass();
+    test_pair_solve();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,55 @@
+#include <cassert>
+#include <cstdlib>
+#include <queue>
+
+#include <casspir.hh>
+
+static void test_parallel_solve()
+{
+    Casspir::ThreadPool thread_pool(4);
+    assert( thread_pool.size() == 4 );
+
+    for (uint32_t i = 0; i < 20; i++) {
+        Casspir::Map serial_map = casspir_generate_map(30,16, 80, Casspir::Point(15,8));
+        Casspir::Map parallel_map = serial_map;
+
+        std::queue<Casspir::Operation> serial = casspir_solve(serial_map);
+        std::queue<Casspir::Operation> parallel = casspir_solve(parallel_map, thread_pool);
+
+        //Both should play exactly the same game.
+        assert( serial.size() == parallel.size() );
+        while (!serial.empty()) {
+            assert( serial.front().type == parallel.front().type );
+            assert( serial.front().position == parallel.front().position );
+            serial.pop();
+            parallel.pop();
+        }
+        assert( serial_map.get_status() == parallel_map.get_status() );
+        assert( serial_map.get_num_flipped() == parallel_map.get_num_flipped() );
+    }
+}
+
+static void test_parallel_for()
+{
+    Casspir::ThreadPool thread_pool(3);
+    std::vector<uint64_t> squares(1000, 0);
+
+    //Every index should be run exactly once, repeatedly.
+    for (uint32_t round = 0; round < 10; round++) {
+        thread_pool.parallel_for(squares.size(), [&squares](size_t i) {
+            squares[i] += i * i;
+        });
+    }
+
+    for (uint64_t i = 0; i < squares.size(); i++) {
+        assert( squares[i] == 10 * i * i );
+    }
+}
+
+int main (void)
+{
+    test_parallel_for();
+    test_parallel_solve();
+
+    return EXIT_SUCCESS;
+}
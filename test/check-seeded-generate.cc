@@ -0,0 +1,58 @@
+#include <cassert>
+#include <cstdlib>
+
+#include <casspir.hh>
+
+static void test_seeded_generate()
+{
+    Casspir::Point click(15,8);
+    Casspir::Map map = casspir_generate_seeded_map(30,16, 99, click, 1234);
+
+    //Exactly the requested mines, none next to the first flip.
+    assert( map.get_total_mines() == 99 );
+    assert( map.get_mines().count() == 99 );
+    assert( !map.get_tile(click).mine );
+    for (Casspir::Point neighbour : map.get_neighbours(click)) {
+        assert( !map.get_tile(neighbour).mine );
+    }
+    assert( map.get_tile(click).flipped );
+
+    //The same seed gives the same map, another seed doesn't.
+    Casspir::Map same = casspir_generate_seeded_map(30,16, 99, click, 1234);
+    Casspir::Map other = casspir_generate_seeded_map(30,16, 99, click, 1235);
+    bool differs = false;
+    for (uint64_t i = 0; i < map.get_size(); i++) {
+        assert( map.is_mine(i) == same.is_mine(i) );
+        assert( map.get_value(i) == same.get_value(i) );
+        differs |= map.is_mine(i) != other.is_mine(i);
+    }
+    assert( differs );
+
+    //Regenerating in place matches a new map.
+    other.generate_seeded(99, click, 1234);
+    for (uint64_t i = 0; i < map.get_size(); i++) {
+        assert( map.is_mine(i) == other.is_mine(i) );
+    }
+    assert( other.get_num_flipped() == map.get_num_flipped() );
+}
+
+static void test_seeded_generate_full()
+{
+    //Asking for too many fills every tile outside the first flip's neighbourhood.
+    Casspir::Map corner = casspir_generate_seeded_map(10,10, 1000, Casspir::Point(0,0), 1);
+    assert( corner.get_total_mines() == 96 );
+
+    Casspir::Map middle = casspir_generate_seeded_map(10,10, 1000, Casspir::Point(5,5), 1);
+    assert( middle.get_total_mines() == 91 );
+    assert( middle.get_num_flipped() == 9 );
+
+    assert( casspir_mines_for_density(30,16, .20625) == 99 );
+}
+
+int main (void)
+{
+    test_seeded_generate();
+    test_seeded_generate_full();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,161 @@
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <casspir.hh>
+#include <Service.hh>
+
+using namespace Casspir::ServiceFormat;
+
+/**
+ * Copy the mines out of a map, as a client would send them.
+ */
+static std::vector<uint64_t> mine_words(Casspir::Map& map)
+{
+    const Casspir::Bitplane& mines = map.get_mines();
+    std::vector<uint64_t> words;
+    for (uint64_t w = 0; w < mines.num_words(); w++) {
+        words.push_back(mines.word(w));
+    }
+    return words;
+}
+
+static void test_generate()
+{
+    Casspir::Service service;
+    std::vector<uint8_t> request, response;
+    GenerateRequest generate = {30, 16, 15, 8, 99, 7};
+    append_generate(request, 42, generate);
+    assert( service.handle(request.data(), request.size(), response) );
+
+    //The same board as generating it locally.
+    ResponseHeader header = read<ResponseHeader>(response.data());
+    assert( header.type == GENERATE );
+    assert( header.status == OK );
+    assert( header.id == 42 );
+    assert( header.length == response.size() - sizeof(ResponseHeader) );
+
+    Casspir::Map map = casspir_generate_seeded_map(30, 16, 99, Casspir::Point(15, 8), 7);
+    std::vector<uint64_t> expected = mine_words(map);
+    GenerateResponse generated = read<GenerateResponse>(response.data() + sizeof(ResponseHeader));
+    assert( generated.num_mines == 99 );
+    assert( header.length == sizeof(GenerateResponse) + expected.size() * sizeof(uint64_t) );
+    assert( std::memcmp(response.data() + sizeof(ResponseHeader) + sizeof(GenerateResponse), expected.data(), header.length - sizeof(GenerateResponse)) == 0 );
+}
+
+static void test_solve_and_hint()
+{
+    Casspir::Map map = casspir_generate_seeded_map(30, 16, 99, Casspir::Point(15, 8), 3);
+    std::vector<uint64_t> mines = mine_words(map);
+
+    std::vector<uint64_t> expected;
+    Casspir::Map solved = map;
+    casspir_solve(solved, [&](const Casspir::Operation& operation) {
+        expected.push_back(operation.encode(30));
+    });
+    assert( expected.size() > 2 );
+
+    //Pipelined requests are separate messages in one buffer, handled by one service in turn.
+    BoardRequest board = {30, 16, 15, 8, 0};
+    BoardRequest played = {30, 16, 15, 8, 2};
+    std::vector<uint8_t> requests;
+    append_board(requests, SOLVE, 1, board, mines.data(), nullptr);
+    size_t hint_offset = requests.size();
+    append_board(requests, HINT, 2, board, mines.data(), nullptr);
+    size_t played_offset = requests.size();
+    append_board(requests, HINT, 3, played, mines.data(), expected.data());
+
+    Casspir::Service service;
+    std::vector<uint8_t> response;
+
+    //Solving gives the same moves as solving locally.
+    assert( service.handle(requests.data(), hint_offset, response) );
+    ResponseHeader header = read<ResponseHeader>(response.data());
+    assert( header.status == OK && header.id == 1 );
+    SolveResponse result = read<SolveResponse>(response.data() + sizeof(ResponseHeader));
+    assert( result.map_status == static_cast<uint32_t>(solved.get_status()) );
+    assert( result.num_operations == expected.size() );
+    assert( std::memcmp(response.data() + sizeof(ResponseHeader) + sizeof(SolveResponse), expected.data(), expected.size() * sizeof(uint64_t)) == 0 );
+
+    //A hint is the next move solving would make.
+    assert( service.handle(requests.data() + hint_offset, played_offset - hint_offset, response) );
+    HintResponse hint = read<HintResponse>(response.data() + sizeof(ResponseHeader));
+    assert( hint.found );
+    assert( hint.operation == expected[0] );
+
+    //After moves already played a certain hint is never wrong.
+    assert( service.handle(requests.data() + played_offset, requests.size() - played_offset, response) );
+    assert( read<ResponseHeader>(response.data()).id == 3 );
+    hint = read<HintResponse>(response.data() + sizeof(ResponseHeader));
+    assert( hint.found );
+    Casspir::Operation next = Casspir::Operation::decode(hint.operation, 30);
+    assert( !hint.certain || map.get_tile(next.position).mine == (next.type == Casspir::OperationType::FLAG) );
+}
+
+static void test_bad_requests()
+{
+    Casspir::Service service;
+    std::vector<uint8_t> request, response;
+
+    //A click off the board.
+    GenerateRequest generate = {9, 9, 9, 0, 10, 0};
+    append_generate(request, 5, generate);
+    assert( !service.handle(request.data(), request.size(), response) );
+    ResponseHeader header = read<ResponseHeader>(response.data());
+    assert( header.status == BAD_REQUEST );
+    assert( header.id == 5 );
+    assert( header.length == 0 );
+    assert( response.size() == sizeof(ResponseHeader) );
+
+    //A truncated message.
+    request.clear();
+    generate.click_x = 4;
+    append_generate(request, 6, generate);
+    assert( !service.handle(request.data(), request.size() - 1, response) );
+    assert( read<ResponseHeader>(response.data()).status == BAD_REQUEST );
+
+    //An operation off the board.
+    request.clear();
+    std::vector<uint64_t> mines(2, 0);
+    uint64_t operation = 81 << 1;
+    BoardRequest board = {9, 9, 4, 4, 1};
+    append_board(request, SOLVE, 7, board, mines.data(), &operation);
+    assert( !service.handle(request.data(), request.size(), response) );
+
+    //An unknown type.
+    request.clear();
+    append_generate(request, 8, generate);
+    request[0] = 9;
+    assert( !service.handle(request.data(), request.size(), response) );
+}
+
+static void test_latencies()
+{
+    Casspir::Latencies latencies;
+    assert( latencies.percentile(.5) == 0 );
+
+    for (uint64_t ns = 100; ns > 0; ns--) {
+        latencies.add(ns);
+    }
+    assert( latencies.percentile(.5) == 50 );
+    assert( latencies.percentile(.99) == 99 );
+    assert( latencies.percentile(1) == 100 );
+    assert( latencies.percentile(0) == 1 );
+
+    Casspir::Latencies more;
+    more.add(1000);
+    latencies.merge(more);
+    assert( latencies.size() == 101 );
+    assert( latencies.percentile(1) == 1000 );
+}
+
+int main (void)
+{
+    test_generate();
+    test_solve_and_hint();
+    test_bad_requests();
+    test_latencies();
+
+    return EXIT_SUCCESS;
+}
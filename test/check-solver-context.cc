@@ -0,0 +1,95 @@
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include <casspir.hh>
+
+//Every allocation in the program is counted.
+static uint64_t allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    allocations++;
+    void* pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+static void test_shared_context()
+{
+    Casspir::SolverContext context;
+    std::vector<uint64_t> operations;
+    Casspir::OperationSink sink = [&operations](const Casspir::Operation& operation) {
+        operations.push_back(operation.encode(30));
+    };
+
+    for (uint64_t seed = 0; seed < 20; seed++) {
+        Casspir::Map map = casspir_generate_seeded_map(30,16, 99, Casspir::Point(15,8), seed);
+        Casspir::Map own_map = map;
+
+        //A context carried over from other boards should play the same game as a fresh solver.
+        operations.clear();
+        casspir_solve(map, context, sink);
+        std::vector<uint64_t> shared(operations);
+
+        operations.clear();
+        casspir_solve(own_map, sink);
+        assert( shared == operations );
+        assert( map.get_status() == own_map.get_status() );
+    }
+}
+
+static void test_no_allocations()
+{
+    std::vector<Casspir::Map> maps;
+    for (uint64_t seed = 0; seed < 20; seed++) {
+        maps.push_back(casspir_generate_seeded_map(16,16, 40, Casspir::Point(8,8), seed));
+    }
+
+    Casspir::SolverContext context;
+    std::vector<uint64_t> operations;
+    operations.reserve(16 * 16 * 2);
+    Casspir::OperationSink sink = [&operations](const Casspir::Operation& operation) {
+        operations.push_back(operation.encode(16));
+    };
+
+    //The first round grows the context to fit, the second plays the same games again.
+    for (int round = 0; round < 2; round++) {
+        uint64_t solve_allocations = 0;
+        for (Casspir::Map& map : maps) {
+            map.reset();
+            map.flip(Casspir::Point(8,8));
+            operations.clear();
+
+            uint64_t before = allocations;
+            casspir_solve(map, context, sink);
+            solve_allocations += allocations - before;
+        }
+
+        //Statistics keep their own lists.
+        if (round == 1 && !Casspir::SolverStats::ENABLED) {
+            assert( solve_allocations == 0 );
+        }
+    }
+}
+
+int main (void)
+{
+    test_shared_context();
+    test_no_allocations();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,59 @@
+#include <cassert>
+#include <cstdlib>
+
+#include <casspir.hh>
+
+static void test_solver_stats()
+{
+    Casspir::SolverStats stats;
+    uint64_t operations = 0;
+    for (uint64_t seed = 0; seed < 10; seed++) {
+        Casspir::Map map = casspir_generate_seeded_map(30,16, 99, Casspir::Point(15,8), seed);
+
+        Casspir::SolverStats board_stats;
+        casspir_solve(map, [&operations](const Casspir::Operation&) {
+            operations++;
+        }, board_stats);
+
+        stats.basic_pass.calls += board_stats.basic_pass.calls;
+        stats.enumerate_groups.calls += board_stats.enumerate_groups.calls;
+        stats.evaluate_group.calls += board_stats.evaluate_group.calls;
+        stats.tiles_scanned += board_stats.tiles_scanned;
+        stats.groups_reused += board_stats.groups_reused;
+        stats.assignments_tried += board_stats.assignments_tried;
+        stats.assignments_accepted += board_stats.assignments_accepted;
+
+        uint64_t groups = 0;
+        for (uint64_t count : board_stats.group_sizes) {
+            groups += count;
+        }
+        assert( groups == board_stats.evaluate_group.calls );
+        assert( board_stats.assignments_accepted <= board_stats.assignments_tried );
+    }
+    assert( operations > 0 );
+
+    if (Casspir::SolverStats::ENABLED) {
+        //Expert boards always need more than the basic pass.
+        assert( stats.basic_pass.calls > 0 );
+        assert( stats.enumerate_groups.calls > 0 );
+        assert( stats.evaluate_group.calls > 0 );
+        assert( stats.tiles_scanned > 0 );
+        assert( stats.assignments_accepted > 0 );
+
+        //Guessing leaves groups away from the guess unchanged for the next enumeration.
+        assert( stats.groups_reused > 0 );
+    } else {
+        //Nothing is gathered.
+        assert( stats.basic_pass.calls == 0 );
+        assert( stats.tiles_scanned == 0 );
+        assert( stats.assignments_tried == 0 );
+        assert( stats.groups_reused == 0 );
+    }
+}
+
+int main (void)
+{
+    test_solver_stats();
+
+    return EXIT_SUCCESS;
+}
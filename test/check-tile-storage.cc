@@ -0,0 +1,61 @@
+#include <cassert>
+#include <cstdlib>
+#include <set>
+
+#include <casspir.hh>
+
+static void test_tile_storage()
+{
+    std::set<Casspir::Point> mines = {
+        Casspir::Point(0,0),
+        Casspir::Point(1,0),
+        Casspir::Point(2,1),
+        Casspir::Point(6,6)
+    };
+    Casspir::Map map = casspir_make_map(7,7, mines);
+
+    map.flag(Casspir::Point(0,0));
+    map.flip(Casspir::Point(6,0));
+
+    //Tiles should unpack to the same values as before packing.
+    Casspir::TileState mine = map.get_tile(Casspir::Point(0,0));
+    assert( mine.mine && mine.flagged && !mine.flipped );
+
+    Casspir::TileState crowded = map.get_tile(Casspir::Point(1,1));
+    assert( crowded.value == 3 && !crowded.mine && !crowded.flagged );
+
+    Casspir::TileState corner = map.get_tile(Casspir::Point(6,0));
+    assert( corner.value == 0 && corner.flipped );
+
+    //The state snapshot should agree with the individual tiles.
+    std::vector<Casspir::TileState> state = map.get_state();
+    assert( state.size() == 49 );
+    for (uint64_t i = 0; i < state.size(); i++) {
+        Casspir::TileState tile = map.get_tile(i);
+        assert( state[i].value == tile.value );
+        assert( state[i].mine == tile.mine );
+        assert( state[i].flagged == tile.flagged );
+        assert( state[i].flipped == tile.flipped );
+    }
+
+    //The planes should count what the tiles report.
+    assert( map.get_mines().count() == 4 );
+    assert( map.get_flagged().count() == 1 );
+    assert( map.get_flipped().count() == map.get_num_flipped() );
+}
+
+static void test_memory_usage()
+{
+    Casspir::Map map = casspir_make_map(1000,1000, std::set<Casspir::Point>());
+
+    //Packed storage should be at least 4 times smaller than a TileState per tile.
+    assert( map.get_memory_usage() * 4 <= map.get_size() * sizeof(Casspir::TileState) );
+}
+
+int main (void)
+{
+    test_tile_storage();
+    test_memory_usage();
+
+    return EXIT_SUCCESS;
+}
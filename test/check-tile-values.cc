@@ -0,0 +1,80 @@
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+
+#include <casspir.hh>
+#include <Random.hh>
+#include <TileValues.hh>
+
+/**
+ * Count a tile's neighbouring mines the slow way.
+ */
+static uint8_t count_neighbours(Casspir::Map& map, uint64_t index)
+{
+    uint8_t count = 0;
+    for (uint64_t neighbour : map.get_neighbours(index)) {
+        count += map.is_mine(neighbour);
+    }
+    return count;
+}
+
+static void test_kernels_agree()
+{
+    const Casspir::TileValues::Kernel kernels[] = {
+        Casspir::TileValues::Kernel::SCALAR,
+        Casspir::TileValues::Kernel::SSE2,
+        Casspir::TileValues::Kernel::AVX2,
+        Casspir::TileValues::Kernel::AUTO
+    };
+
+    //Odd widths put rows across nibbles, and widths around 64 across words and vectors.
+    const uint32_t widths[] = {1, 2, 3, 7, 15, 16, 17, 31, 33, 63, 64, 65, 100, 129};
+    Casspir::Random random(18);
+
+    for (uint32_t w : widths) {
+        for (uint32_t h : {1u, 2u, 5u, 16u}) {
+            uint64_t size = static_cast<uint64_t>(w) * h;
+            std::vector<uint64_t> words((size + 63) / 64);
+            for (uint64_t& word : words) {
+                word = random.next() & random.next();
+            }
+            Casspir::Map map(w, h, words.data());
+
+            for (uint64_t i = 0; i < size; i++) {
+                assert( map.get_value(i) == count_neighbours(map, i) );
+            }
+
+            for (Casspir::TileValues::Kernel kernel : kernels) {
+                if (!Casspir::TileValues::is_supported(kernel)) {
+                    continue;
+                }
+
+                std::vector<uint8_t> values((size + 1) / 2, 0xFF);
+                Casspir::TileValues::compute(map.get_mines(), w, h, values, kernel);
+                for (uint64_t i = 0; i < size; i++) {
+                    assert( ((values[i >> 1] >> ((i & 1) << 2)) & 0xF) == map.get_value(i) );
+                }
+            }
+        }
+    }
+}
+
+static void test_full_board()
+{
+    //Every tile a mine, so values are only limited by the edges.
+    std::vector<uint64_t> words(2, ~0ULL);
+    Casspir::Map map(9, 9, words.data());
+
+    assert( map.get_total_mines() == 81 );
+    assert( map.get_tile(Casspir::Point(0,0)).value == 3 );
+    assert( map.get_tile(Casspir::Point(4,0)).value == 5 );
+    assert( map.get_tile(Casspir::Point(4,4)).value == 8 );
+}
+
+int main (void)
+{
+    test_kernels_agree();
+    test_full_board();
+
+    return EXIT_SUCCESS;
+}